@@ -0,0 +1,168 @@
+/* File: arena.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include "list.h"
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define ARENA_HUGE_PAGE (2UL << 20)
+#define ARENA_SLOT      sizeof(struct list)
+#define ARENA_ROUND(A, B) (((A) + (B) - 1) / (B) * (B))
+
+/*
+ * The memory is taken from the system in large mappings (regions) and handed
+ * out as node sized slots. The freed slots are chained and reused and it all
+ * goes back to the system with the arena. Anything bigger than a slot (like
+ * the list's metadata) comes from malloc instead, so a freed pointer outside
+ * the regions is passed to free, which also covers the values freed by
+ * listFreeDeep.
+ */
+struct arenaRegion
+{
+    struct arenaRegion* next;
+    size_t              size;
+};
+
+struct arenaSlot
+{
+    struct arenaSlot* next;
+};
+
+struct listArena
+{
+    struct arenaRegion* regions;
+    struct arenaSlot*   free;
+    char*               bump;   /* the unused rest of the newest region */
+    char*               end;
+    size_t              region;
+    int                 flags;
+};
+
+static int arenaGrow(ListArena arena)
+{
+    struct arenaRegion* region;
+    size_t header = ARENA_ROUND(sizeof(struct arenaRegion), ARENA_SLOT);
+    size_t size   = arena->region;
+    void*  addr   = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (arena->flags & LIST_ARENA_HUGETLB)
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (addr == MAP_FAILED)
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED)
+        return 0;
+#ifdef MADV_HUGEPAGE
+    if (arena->flags & LIST_ARENA_THP)
+        madvise(addr, size, MADV_HUGEPAGE);
+#endif
+
+    region          = (struct arenaRegion*) addr;
+    region->size    = size;
+    region->next    = arena->regions;
+    arena->regions  = region;
+    arena->bump     = (char*) addr + header;
+    arena->end      = (char*) addr + size;
+    return 1;
+}
+
+static void* arenaAlloc(size_t size, void* ctx)
+{
+    ListArena arena = (ListArena) ctx;
+    void*     ptr;
+
+    if (size > ARENA_SLOT)
+        return malloc(size);
+    if (arena->free)
+    {
+        ptr         = arena->free;
+        arena->free = arena->free->next;
+        return ptr;
+    }
+    if (arena->bump == arena->end && !arenaGrow(arena))
+        return NULL;
+    ptr          = arena->bump;
+    arena->bump += ARENA_SLOT;
+    return ptr;
+}
+
+static int arenaOwns(ListArena arena, const void* ptr)
+{
+    const struct arenaRegion* region;
+    for (region = arena->regions; region; region = region->next)
+        if ((const char*) ptr >= (const char*) region
+            && (const char*) ptr < (const char*) region + region->size)
+            return 1;
+    return 0;
+}
+
+static void arenaFree(void* ptr, void* ctx)
+{
+    ListArena         arena = (ListArena) ctx;
+    struct arenaSlot* slot  = (struct arenaSlot*) ptr;
+    if (slot == NULL)
+        return;
+    if (!arenaOwns(arena, slot))
+    {
+        free(ptr);
+        return;
+    }
+    slot->next  = arena->free;
+    arena->free = slot;
+}
+
+ListArena listArenaCreate(size_t region, int flags)
+{
+    ListArena arena = (ListArena) malloc(sizeof(struct listArena));
+    if (arena == NULL)
+        return NULL;
+    if (region == 0)
+        region = 32 * ARENA_HUGE_PAGE;
+    arena->regions = NULL;
+    arena->free    = NULL;
+    arena->bump    = NULL;
+    arena->end     = NULL;
+    arena->region  = ARENA_ROUND(region, ARENA_HUGE_PAGE);
+    arena->flags   = flags;
+    return arena;
+}
+
+void listArenaAllocator(ListArena arena, ListAllocator* out)
+{
+    out->alloc = arenaAlloc;
+    out->free  = arenaFree;
+    out->ctx   = arena;
+}
+
+void listArenaDestroy(ListArena arena)
+{
+    struct arenaRegion* region;
+    if (arena == NULL)
+        return;
+    while ((region = arena->regions))
+    {
+        arena->regions = region->next;
+        munmap(region, region->size);
+    }
+    free(arena);
+}
@@ -0,0 +1,249 @@
+/* File: chan.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "chan.h"
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+/*
+ * The buffered values are kept in an ordinary list. The batch functions move
+ * whole chains of nodes between it and the caller's lists, so a batch costs
+ * a single lock acquisition and no allocations.
+ */
+struct chan
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  notEmpty;
+    pthread_cond_t  notFull;
+    List            items;
+    size_t          length;
+    size_t          capacity;   /* 0 if unbounded */
+    int             closed;
+};
+
+#define chanRoom(A) ((A)->capacity ? (A)->capacity - (A)->length : (size_t) -1)
+
+/* turns the relative timeout in milliseconds into a CLOCK_MONOTONIC deadline */
+static void chanDeadline(long timeout, struct timespec* deadline)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec  += timeout / 1000;
+    deadline->tv_nsec += timeout % 1000 * 1000000L;
+    if (deadline->tv_nsec >= 1000000000L)
+    {
+        ++deadline->tv_sec;
+        deadline->tv_nsec -= 1000000000L;
+    }
+}
+
+/* returns 0 if the deadline has passed, assumes the lock is held */
+static int chanWait(Chan chan, pthread_cond_t* cond, long timeout,
+                    const struct timespec* deadline)
+{
+    if (timeout == 0)
+        return 0;
+    if (timeout < 0)
+    {
+        pthread_cond_wait(cond, &chan->lock);
+        return 1;
+    }
+    return pthread_cond_timedwait(cond, &chan->lock, deadline) != ETIMEDOUT;
+}
+
+Chan chanInit(size_t capacity)
+{
+    pthread_condattr_t attr;
+    Chan chan = (Chan) malloc(sizeof(struct chan));
+    if (chan == NULL)
+        return NULL;
+    chan->items = listInit();
+    if (chan->items == NULL)
+    {
+        free(chan);
+        return NULL;
+    }
+    chan->length   = 0;
+    chan->capacity = capacity;
+    chan->closed   = 0;
+
+    pthread_mutex_init(&chan->lock, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&chan->notEmpty, &attr);
+    pthread_cond_init(&chan->notFull, &attr);
+    pthread_condattr_destroy(&attr);
+    return chan;
+}
+
+void chanFree(Chan chan)
+{
+    if (chan == NULL)
+        return;
+    listFree(chan->items);
+    pthread_cond_destroy(&chan->notFull);
+    pthread_cond_destroy(&chan->notEmpty);
+    pthread_mutex_destroy(&chan->lock);
+    free(chan);
+}
+
+void chanClose(Chan chan)
+{
+    pthread_mutex_lock(&chan->lock);
+    chan->closed = 1;
+    pthread_cond_broadcast(&chan->notEmpty);
+    pthread_cond_broadcast(&chan->notFull);
+    pthread_mutex_unlock(&chan->lock);
+}
+
+int chanSend(Chan chan, void* val, long timeout)
+{
+    struct timespec deadline;
+    int result = CHAN_OK;
+
+    if (timeout > 0)
+        chanDeadline(timeout, &deadline);
+    pthread_mutex_lock(&chan->lock);
+    while (!chan->closed && chanRoom(chan) == 0)
+        if (!chanWait(chan, &chan->notFull, timeout, &deadline))
+            break;
+
+    if (chan->closed)
+        result = CHAN_CLOSED;
+    else if (chanRoom(chan) == 0)
+        result = CHAN_TIMEOUT;
+    else if (listAddAfter(chan->items, listIsEmpty(chan->items)
+                          ? chan->items : listRBegin(chan->items), val) == NULL)
+        result = CHAN_NOMEM;
+    else
+    {
+        ++chan->length;
+        pthread_cond_signal(&chan->notEmpty);
+    }
+    pthread_mutex_unlock(&chan->lock);
+    return result;
+}
+
+/* On CHAN_TIMEOUT or CHAN_CLOSED the unsent values are left in the batch,
+ * the ones before them have already been sent. */
+int chanSendList(Chan chan, List batch, long timeout)
+{
+    struct timespec deadline;
+    size_t count = listSize(batch);
+    size_t moved;
+    int    result = CHAN_OK;
+
+    if (timeout > 0)
+        chanDeadline(timeout, &deadline);
+    pthread_mutex_lock(&chan->lock);
+    while (count > 0)
+    {
+        while (!chan->closed && chanRoom(chan) == 0)
+            if (!chanWait(chan, &chan->notFull, timeout, &deadline))
+                break;
+        if (chan->closed)
+        {
+            result = CHAN_CLOSED;
+            break;
+        }
+        if (chanRoom(chan) == 0)
+        {
+            result = CHAN_TIMEOUT;
+            break;
+        }
+
+        if (chanRoom(chan) >= count)
+        {
+            listSplice(chan->items, batch);
+            moved = count;
+        }
+        else
+            moved = listSpliceN(chan->items, batch, chanRoom(chan));
+        chan->length += moved;
+        count        -= moved;
+        pthread_cond_broadcast(&chan->notEmpty);
+    }
+    pthread_mutex_unlock(&chan->lock);
+    return result;
+}
+
+int chanRecv(Chan chan, void** val, long timeout)
+{
+    struct timespec deadline;
+    int result = CHAN_OK;
+
+    if (timeout > 0)
+        chanDeadline(timeout, &deadline);
+    pthread_mutex_lock(&chan->lock);
+    while (!chan->closed && chan->length == 0)
+        if (!chanWait(chan, &chan->notEmpty, timeout, &deadline))
+            break;
+
+    if (chan->length == 0)
+        result = chan->closed ? CHAN_CLOSED : CHAN_TIMEOUT;
+    else
+    {
+        *val = listPopFront(chan->items);
+        --chan->length;
+        pthread_cond_signal(&chan->notFull);
+    }
+    pthread_mutex_unlock(&chan->lock);
+    return result;
+}
+
+/* appends up to max values (all of them if max is 0) to out */
+int chanRecvList(Chan chan, List out, size_t max, long timeout)
+{
+    struct timespec deadline;
+    int result = CHAN_OK;
+
+    if (timeout > 0)
+        chanDeadline(timeout, &deadline);
+    pthread_mutex_lock(&chan->lock);
+    while (!chan->closed && chan->length == 0)
+        if (!chanWait(chan, &chan->notEmpty, timeout, &deadline))
+            break;
+
+    if (chan->length == 0)
+        result = chan->closed ? CHAN_CLOSED : CHAN_TIMEOUT;
+    else
+    {
+        if (max == 0 || max >= chan->length)
+        {
+            listSplice(out, chan->items);
+            chan->length = 0;
+        }
+        else
+            chan->length -= listSpliceN(out, chan->items, max);
+        pthread_cond_broadcast(&chan->notFull);
+    }
+    pthread_mutex_unlock(&chan->lock);
+    return result;
+}
+
+size_t chanLength(Chan chan)
+{
+    size_t length;
+    pthread_mutex_lock(&chan->lock);
+    length = chan->length;
+    pthread_mutex_unlock(&chan->lock);
+    return length;
+}
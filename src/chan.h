@@ -0,0 +1,57 @@
+/* File: chan.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _CHAN_H_
+#define _CHAN_H_
+
+#include <stddef.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct chan* Chan;
+
+/* results of the send and receive functions */
+enum
+{
+    CHAN_OK      = 0,
+    CHAN_TIMEOUT = 1,           /* also returned when it would block */
+    CHAN_CLOSED  = 2,
+    CHAN_NOMEM   = 3
+};
+
+Chan   chanInit     (size_t capacity);
+void   chanFree     (Chan chan);
+void   chanClose    (Chan chan);
+
+int    chanSend     (Chan chan, void* val, long timeout);
+int    chanSendList (Chan chan, List batch, long timeout);
+int    chanRecv     (Chan chan, void** val, long timeout);
+int    chanRecvList (Chan chan, List out, size_t max, long timeout);
+
+size_t chanLength   (Chan chan);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
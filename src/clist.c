@@ -0,0 +1,303 @@
+/* File: clist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "clist.h"
+#include <stdlib.h>
+
+/*
+ * Every node, the root included, always has both neighbours, so linking and
+ * unlinking a node are the same four pointer updates wherever it is and
+ * neither of them needs the root.
+ */
+static void clistLink(CList place, CList element)
+{
+    element->n    = place->n;
+    element->p    = place;
+    place->n->p   = element;
+    place->n      = element;
+}
+
+static void clistUnlink(CList element)
+{
+    element->p->n = element->n;
+    element->n->p = element->p;
+}
+
+CList clistInit(void)
+{
+    CList root = (CList) malloc(sizeof(struct clist));
+    if (root == NULL)
+        return NULL;
+    root->n = root;
+    root->p = root;
+    root->v = NULL;
+    return root;
+}
+
+static void clistFreeNodes(CList root, int deep)
+{
+    CList element = clistBegin(root);
+    CList next;
+    for (; element != root; element = next)
+    {
+        next = clistNext(element);
+        if (deep)
+            free(element->v);
+        free(element);
+    }
+    root->n = root;
+    root->p = root;
+}
+
+void clistFree(CList root)
+{
+    if (root == NULL)
+        return;
+    clistFreeNodes(root, 0);
+    free(root);
+}
+
+void clistFreeDeep(CList root)
+{
+    if (root == NULL)
+        return;
+    clistFreeNodes(root, 1);
+    free(root);
+}
+
+CList clistAddAfter(CList place, void* val)
+{
+    CList element = (CList) malloc(sizeof(struct clist));
+    if (element == NULL)
+        return NULL;
+    element->v = val;
+    clistLink(place, element);
+    return element;
+}
+
+int clistPushBack(CList root, void* val)
+{
+    return clistAddAfter(clistRBegin(root), val) != NULL;
+}
+
+int clistPushFront(CList root, void* val)
+{
+    return clistAddAfter(root, val) != NULL;
+}
+
+/* compare should return -1 on lesser, 0 on equal and 1 on greater */
+int clistPushSort(CList root, void* val, int (*compare)(const void*, const void*))
+{
+    CList place = root;
+    while (place->n != root && compare(place->n->v, val) < 0)
+        place = place->n;
+    return clistAddAfter(place, val) != NULL;
+}
+
+CList clistGet(CList root, size_t n)
+{
+    CList element = clistBegin(root);
+    for (; element != root && n > 0; --n)
+        element = clistNext(element);
+    return element != root ? element : NULL;    /* out-of-list exception */
+}
+
+CList clistGetVal(CList root, void* val, int (*compare)(const void*, const void*))
+{
+    CList element = clistBegin(root);
+    for (; element != root; element = clistNext(element))
+        if (compare(element->v, val) == 0)
+            return element;
+    return NULL;
+}
+
+void clistRemove(CList element)
+{
+    clistUnlink(element);
+    free(element);
+}
+
+int clistRemoveN(CList root, size_t n)
+{
+    CList element = clistGet(root, n);
+    if (element == NULL)
+        return 0;               /* out-of-list exception */
+    clistRemove(element);
+    return 1;
+}
+
+int clistRemoveVal(CList root, void* val, int (*compare)(const void*, const void*))
+{
+    CList element = clistGetVal(root, val, compare);
+    if (element == NULL)
+        return 0;
+    clistRemove(element);
+    return 1;
+}
+
+void clistMoveAfter(CList place, CList element)
+{
+    if (place == element || place->n == element)
+        return;
+    clistUnlink(element);
+    clistLink(place, element);
+}
+
+size_t clistLength(CList root)
+{
+    size_t i = 0;
+    CList  element;
+    for (element = clistBegin(root); element != root; element = clistNext(element))
+        ++i;
+    return i;
+}
+
+int clistIsEmpty(CList root)
+{
+    return root->n == root;
+}
+
+void clistEmpty(CList root)
+{
+    clistFreeNodes(root, 0);
+}
+
+void* clistPopBack(CList root)
+{
+    CList last = clistRBegin(root);
+    void* val  = last->v;
+    if (last == root)
+        return NULL;
+    clistRemove(last);
+    return val;
+}
+
+void* clistPopFront(CList root)
+{
+    CList first = clistBegin(root);
+    void* val   = first->v;
+    if (first == root)
+        return NULL;
+    clistRemove(first);
+    return val;
+}
+
+CList clistCopy(CList source)
+{
+    CList copy = clistInit();
+    CList element;
+    if (copy == NULL)
+        return NULL;
+    for (element = clistBegin(source); element != source; element = clistNext(element))
+        if (clistAddAfter(clistRBegin(copy), element->v) == NULL)
+        {
+            clistFree(copy);
+            return NULL;
+        }
+    return copy;
+}
+
+void clistForeach(CList root, void (*fun)(void*, void*), void* arg)
+{
+    CList element;
+    for (element = clistBegin(root); element != root; element = clistNext(element))
+        fun(element->v, arg);
+}
+
+/* swaps the values of the node and the next one */
+int clistSwap(CList root, CList place)
+{
+    void* val;
+    if (place == root || place->n == root)
+        return 0;
+    val         = place->v;
+    place->v    = place->n->v;
+    place->n->v = val;
+    return 1;
+}
+
+/*
+ * Simon Tatham's merge sort, like listSort. The ring is cut open for the
+ * time of sorting; the last merge leaves the tail at hand, so closing it
+ * again takes no extra pass.
+ */
+void clistSort(CList root, int (*cmp)(const void*, const void*))
+{
+    CList  list, p, q, e, tail;
+    size_t insize = 1, nmerges, psize, qsize, i;
+
+    if (root->n == root->p)
+        return;                 /* up to one element */
+    list       = root->n;
+    root->p->n = NULL;
+
+    for (;;)
+    {
+        p       = list;
+        list    = NULL;
+        tail    = NULL;
+        nmerges = 0;
+
+        while (p)
+        {
+            ++nmerges;
+            q     = p;
+            psize = 0;
+            for (i = 0; i < insize && q; ++i)
+            {
+                ++psize;
+                q = q->n;
+            }
+            qsize = insize;
+
+            while (psize > 0 || (qsize > 0 && q))
+            {
+                if (psize == 0 || (qsize > 0 && q && cmp(p->v, q->v) > 0))
+                {
+                    e = q;
+                    q = q->n;
+                    --qsize;
+                }
+                else
+                {
+                    e = p;
+                    p = p->n;
+                    --psize;
+                }
+
+                if (tail)
+                    tail->n = e;
+                else
+                    list = e;
+                e->p = tail;
+                tail = e;
+            }
+            p = q;
+        }
+        tail->n = NULL;
+
+        if (nmerges <= 1)
+            break;
+        insize *= 2;
+    }
+
+    root->n = list;
+    list->p = root;
+    tail->n = root;
+    root->p = tail;
+}
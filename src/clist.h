@@ -0,0 +1,78 @@
+/* File: clist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _CLIST_H_
+#define _CLIST_H_
+
+#include <stddef.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+/* The root is a sentinel: the list is a ring, empty if the root points to
+ * itself, so no link is ever NULL. */
+typedef struct clist
+{
+    struct clist* n;            /* pointer to the next element */
+    struct clist* p;            /* pointer to the previous element */
+    void*         v;            /* data pointer, unused in the root */
+} *CList;
+
+#define clistNext(A)   ((A)->n)
+#define clistPrev(A)   ((A)->p)
+#define clistBegin(A)  ((A)->n)
+#define clistRBegin(A) ((A)->p)
+#define clistEnd(A)    (A)
+#define clistVal(A, T) (*(T*) (A)->v)
+#define clistRef(A, T) ( (T*) (A)->v)
+
+CList  clistInit      (void);
+void   clistFree      (CList root);
+void   clistFreeDeep  (CList root);
+
+int    clistPushBack  (CList root, void* val);
+int    clistPushFront (CList root, void* val);
+int    clistPushSort  (CList root, void* val, int (*compare)(const void*, const void*));
+CList  clistAddAfter  (CList place, void* val);
+
+CList  clistGet       (CList root, size_t n);
+CList  clistGetVal    (CList root, void* val, int (*compare)(const void*, const void*));
+void   clistRemove    (CList element);
+int    clistRemoveN   (CList root, size_t n);
+int    clistRemoveVal (CList root, void* val, int (*compare)(const void*, const void*));
+void   clistMoveAfter (CList place, CList element);
+
+size_t clistLength    (CList root);
+int    clistIsEmpty   (CList root);
+void   clistEmpty     (CList root);
+void*  clistPopBack   (CList root);
+void*  clistPopFront  (CList root);
+
+CList  clistCopy      (CList source);
+void   clistForeach   (CList root, void (*fun)(void*, void*), void* arg);
+int    clistSwap      (CList root, CList place);
+void   clistSort      (CList root, int (*cmp)(const void*, const void*));
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,516 @@
+/* File: cowlist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "cowlist.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+#define COW_CHUNK  64
+#define COW_FANOUT 32
+
+/*
+ * The values are kept in chunks, the leaves of a B-tree whose inner nodes
+ * hold the number of values under each child and all the ones before it, so a
+ * position is found with a binary search on every level. The nodes are
+ * reference counted and shared between a list and its snapshots: a snapshot
+ * only takes a reference to the root, and the first modification of either
+ * copies just the nodes on the path from the root to the modified chunk, each
+ * of them only while it is still shared.
+ */
+struct cowChunk
+{
+    unsigned long refs;
+    size_t        count;
+    void*         v[COW_CHUNK];
+};
+
+struct cowNode
+{
+    unsigned long refs;
+    size_t        count;                /* number of children */
+    size_t        ends[COW_FANOUT];     /* values up to the end of each child */
+    void*         child[COW_FANOUT];    /* chunks at the height 1 */
+};
+
+struct cowList
+{
+    void*  root;                /* NULL if empty */
+    int    height;              /* 0 if the root is a chunk */
+    size_t length;
+};
+
+#define cowRefs(A)    __atomic_load_n(&(A)->refs, __ATOMIC_ACQUIRE)
+#define cowRef(A)     __atomic_add_fetch(&(A)->refs, 1, __ATOMIC_RELAXED)
+#define cowUnref(A)   __atomic_sub_fetch(&(A)->refs, 1, __ATOMIC_ACQ_REL)
+
+#define cowBase(A, i) ((i) ? (A)->ends[(i) - 1] : 0)
+
+static struct cowChunk* cowChunkNew(void)
+{
+    struct cowChunk* chunk = (struct cowChunk*) malloc(sizeof(struct cowChunk));
+    if (chunk)
+    {
+        chunk->refs  = 1;
+        chunk->count = 0;
+    }
+    return chunk;
+}
+
+static struct cowNode* cowNodeNew(void)
+{
+    struct cowNode* node = (struct cowNode*) malloc(sizeof(struct cowNode));
+    if (node)
+    {
+        node->refs  = 1;
+        node->count = 0;
+    }
+    return node;
+}
+
+static void cowRetain(void* ptr, int height)
+{
+    if (height == 0)
+        cowRef((struct cowChunk*) ptr);
+    else
+        cowRef((struct cowNode*) ptr);
+}
+
+static void cowRelease(void* ptr, int height)
+{
+    struct cowNode* node = (struct cowNode*) ptr;
+    size_t          i;
+
+    if (height == 0)
+    {
+        if (cowUnref((struct cowChunk*) ptr) == 0)
+            free(ptr);
+        return;
+    }
+    if (cowUnref(node) != 0)
+        return;
+    for (i = 0; i < node->count; ++i)
+        cowRelease(node->child[i], height - 1);
+    free(node);
+}
+
+/* returns the number of values in the subtree */
+static size_t cowSize(void* ptr, int height)
+{
+    struct cowNode* node = (struct cowNode*) ptr;
+    if (height == 0)
+        return ((struct cowChunk*) ptr)->count;
+    return node->count ? node->ends[node->count - 1] : 0;
+}
+
+static int cowFull(void* ptr, int height)
+{
+    if (height == 0)
+        return ((struct cowChunk*) ptr)->count == COW_CHUNK;
+    return ((struct cowNode*) ptr)->count == COW_FANOUT;
+}
+
+/* makes the subtree in *slot private to the list, sharing its children */
+static int cowUnshare(void** slot, int height)
+{
+    void*  old = *slot;
+    size_t i;
+
+    if (height == 0)
+    {
+        struct cowChunk* chunk = (struct cowChunk*) old;
+        struct cowChunk* copy;
+        if (cowRefs(chunk) == 1)
+            return 1;
+        if ((copy = cowChunkNew()) == NULL)
+            return 0;
+        copy->count = chunk->count;
+        memcpy(copy->v, chunk->v, chunk->count * sizeof(void*));
+        *slot = copy;
+    }
+    else
+    {
+        struct cowNode* node = (struct cowNode*) old;
+        struct cowNode* copy;
+        if (cowRefs(node) == 1)
+            return 1;
+        if ((copy = cowNodeNew()) == NULL)
+            return 0;
+        copy->count = node->count;
+        memcpy(copy->ends, node->ends, node->count * sizeof(size_t));
+        memcpy(copy->child, node->child, node->count * sizeof(void*));
+        for (i = 0; i < node->count; ++i)
+            cowRetain(node->child[i], height - 1);
+        *slot = copy;
+    }
+    cowRelease(old, height);
+    return 1;
+}
+
+/* returns the child holding the nth value or, when inserting, the one to
+ * insert it into; appending goes to the last one */
+static size_t cowFind(struct cowNode* node, size_t n, int insert)
+{
+    size_t lo = 0;
+    size_t hi = node->count - 1;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (node->ends[mid] > n || (insert && node->ends[mid] == n))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+/* adds a child holding size values at pos, there must be room for it */
+static void cowNodeInsert(struct cowNode* node, size_t pos, void* child, size_t size)
+{
+    size_t i;
+    for (i = node->count; i > pos; --i)
+    {
+        node->ends[i]  = node->ends[i - 1] + size;
+        node->child[i] = node->child[i - 1];
+    }
+    node->ends[pos]  = cowBase(node, pos) + size;
+    node->child[pos] = child;
+    ++node->count;
+}
+
+/*
+ * Inserts val at n into the subtree in *slot. A full node is split and its
+ * new right sibling is returned in split for the parent to add. Everything
+ * which may fail is done on the way down, so a failure changes nothing.
+ */
+static int cowInsertAt(void** slot, int height, size_t n, void* val, void** split)
+{
+    *split = NULL;
+    if (!cowUnshare(slot, height))
+        return 0;
+
+    if (height == 0)
+    {
+        struct cowChunk* chunk = (struct cowChunk*) *slot;
+        struct cowChunk* fresh;
+        if (chunk->count == COW_CHUNK)
+        {
+            if ((fresh = cowChunkNew()) == NULL)
+                return 0;
+            if (n < COW_CHUNK)
+            {
+                /* split the full chunk in the middle */
+                fresh->count = COW_CHUNK / 2;
+                memcpy(fresh->v, chunk->v + COW_CHUNK / 2, fresh->count * sizeof(void*));
+                chunk->count = COW_CHUNK / 2;
+                if (n > COW_CHUNK / 2)
+                {
+                    n -= COW_CHUNK / 2;
+                    chunk = fresh;
+                }
+            }
+            else
+            {
+                /* appending, start a new chunk so the old one stays full */
+                n     = 0;
+                chunk = fresh;
+            }
+            *split = fresh;
+        }
+        memmove(chunk->v + n + 1, chunk->v + n, (chunk->count - n) * sizeof(void*));
+        chunk->v[n] = val;
+        ++chunk->count;
+        return 1;
+    }
+    else
+    {
+        struct cowNode* node    = (struct cowNode*) *slot;
+        struct cowNode* sibling = NULL;
+        size_t          i       = cowFind(node, n, 1);
+        size_t          j, size, from;
+        void*           child;
+
+        if (node->count == COW_FANOUT && (sibling = cowNodeNew()) == NULL)
+            return 0;
+        if (!cowInsertAt(&node->child[i], height - 1, n - cowBase(node, i), val, &child))
+        {
+            free(sibling);
+            return 0;
+        }
+        for (j = i; j < node->count; ++j)
+            ++node->ends[j];
+        if (child == NULL)
+        {
+            free(sibling);
+            return 1;
+        }
+
+        /* the new child is counted in the ends of the old one so far */
+        size = cowSize(child, height - 1);
+        for (j = i; j < node->count; ++j)
+            node->ends[j] -= size;
+        if (sibling == NULL)
+        {
+            cowNodeInsert(node, i + 1, child, size);
+            return 1;
+        }
+
+        /* full, appending starts a new node, anything else splits it */
+        from = i + 1 == COW_FANOUT ? COW_FANOUT : COW_FANOUT / 2;
+        for (j = from; j < node->count; ++j)
+        {
+            sibling->ends[j - from]  = node->ends[j] - node->ends[from - 1];
+            sibling->child[j - from] = node->child[j];
+        }
+        sibling->count = node->count - from;
+        node->count    = from;
+        if (i + 1 < from || (i + 1 == from && from < COW_FANOUT))
+            cowNodeInsert(node, i + 1, child, size);
+        else
+            cowNodeInsert(sibling, i + 1 - from, child, size);
+        *split = sibling;
+        return 1;
+    }
+}
+
+/* removes the nth value of the subtree in *slot, dropping the emptied nodes */
+static int cowRemoveAt(void** slot, int height, size_t n)
+{
+    struct cowChunk* chunk;
+    struct cowNode*  node;
+    size_t           i, j;
+
+    if (!cowUnshare(slot, height))
+        return 0;
+    if (height == 0)
+    {
+        chunk = (struct cowChunk*) *slot;
+        --chunk->count;
+        memmove(chunk->v + n, chunk->v + n + 1, (chunk->count - n) * sizeof(void*));
+        return 1;
+    }
+
+    node = (struct cowNode*) *slot;
+    i    = cowFind(node, n, 0);
+    if (!cowRemoveAt(&node->child[i], height - 1, n - cowBase(node, i)))
+        return 0;
+    for (j = i; j < node->count; ++j)
+        --node->ends[j];
+    if (cowSize(node->child[i], height - 1) == 0)
+    {
+        cowRelease(node->child[i], height - 1);
+        --node->count;
+        memmove(node->ends + i, node->ends + i + 1, (node->count - i) * sizeof(size_t));
+        memmove(node->child + i, node->child + i + 1, (node->count - i) * sizeof(void*));
+    }
+    return 1;
+}
+
+static void cowForeachIn(void* ptr, int height, void (*fun)(void*, void*), void* arg)
+{
+    size_t i;
+    if (height == 0)
+    {
+        struct cowChunk* chunk = (struct cowChunk*) ptr;
+        for (i = 0; i < chunk->count; ++i)
+            fun(chunk->v[i], arg);
+    }
+    else
+    {
+        struct cowNode* node = (struct cowNode*) ptr;
+        for (i = 0; i < node->count; ++i)
+            cowForeachIn(node->child[i], height - 1, fun, arg);
+    }
+}
+
+CowList cowListInit(void)
+{
+    CowList list = (CowList) malloc(sizeof(struct cowList));
+    if (list == NULL)
+        return NULL;
+    list->root   = NULL;
+    list->height = 0;
+    list->length = 0;
+    return list;
+}
+
+CowList cowListFromList(List source)
+{
+    CowList list = cowListInit();
+    if (list == NULL)
+        return NULL;
+    while ((source = listNext(source)))
+        if (!cowListPushBack(list, source->v))
+        {
+            cowListFree(list);
+            return NULL;
+        }
+    return list;
+}
+
+CowList cowListSnapshot(CowList list)
+{
+    CowList snapshot = (CowList) malloc(sizeof(struct cowList));
+    if (snapshot == NULL)
+        return NULL;
+    *snapshot = *list;
+    if (snapshot->root)
+        cowRetain(snapshot->root, snapshot->height);
+    return snapshot;
+}
+
+void cowListFree(CowList list)
+{
+    if (list == NULL)
+        return;
+    if (list->root)
+        cowRelease(list->root, list->height);
+    free(list);
+}
+
+int cowListInsert(CowList list, size_t n, void* val)
+{
+    struct cowNode* top = NULL;
+    void*           split;
+
+    if (n > list->length)
+        return 0;
+    if (list->root == NULL && (list->root = cowChunkNew()) == NULL)
+        return 0;
+
+    /* a full root may be split, the new one is allocated in advance */
+    if (cowFull(list->root, list->height) && (top = cowNodeNew()) == NULL)
+        return 0;
+    if (!cowInsertAt(&list->root, list->height, n, val, &split))
+    {
+        free(top);
+        return 0;
+    }
+    if (split)
+    {
+        top->child[0] = list->root;
+        top->ends[0]  = cowSize(list->root, list->height);
+        top->count    = 1;
+        cowNodeInsert(top, 1, split, cowSize(split, list->height));
+        list->root = top;
+        ++list->height;
+    }
+    else
+        free(top);
+    ++list->length;
+    return 1;
+}
+
+int cowListPushBack(CowList list, void* val)
+{
+    return cowListInsert(list, list->length, val);
+}
+
+int cowListPushFront(CowList list, void* val)
+{
+    return cowListInsert(list, 0, val);
+}
+
+int cowListRemoveN(CowList list, size_t n)
+{
+    struct cowNode* node;
+
+    if (n >= list->length || !cowRemoveAt(&list->root, list->height, n))
+        return 0;
+    if (--list->length == 0)
+    {
+        cowRelease(list->root, list->height);
+        list->root   = NULL;
+        list->height = 0;
+    }
+    /* the root is private after the removal, hand its only child over */
+    while (list->height > 0 && (node = (struct cowNode*) list->root)->count == 1)
+    {
+        list->root = node->child[0];
+        free(node);
+        --list->height;
+    }
+    return 1;
+}
+
+void* cowListPopBack(CowList list)
+{
+    void* val;
+    if (list->length == 0)
+        return NULL;
+    val = cowListGet(list, list->length - 1);
+    return cowListRemoveN(list, list->length - 1) ? val : NULL;
+}
+
+void* cowListPopFront(CowList list)
+{
+    void* val = cowListGet(list, 0);
+    return cowListRemoveN(list, 0) ? val : NULL;
+}
+
+void* cowListGet(CowList list, size_t n)
+{
+    void* ptr = list->root;
+    int   height;
+
+    if (n >= list->length)
+        return NULL;            /* out-of-list exception */
+    for (height = list->height; height > 0; --height)
+    {
+        struct cowNode* node = (struct cowNode*) ptr;
+        size_t          i    = cowFind(node, n, 0);
+        n  -= cowBase(node, i);
+        ptr = node->child[i];
+    }
+    return ((struct cowChunk*) ptr)->v[n];
+}
+
+int cowListSet(CowList list, size_t n, void* val)
+{
+    void** slot = &list->root;
+    int    height;
+
+    if (n >= list->length)
+        return 0;
+    for (height = list->height; ; --height)
+    {
+        struct cowNode* node;
+        size_t          i;
+        if (!cowUnshare(slot, height))
+            return 0;
+        if (height == 0)
+            break;
+        node = (struct cowNode*) *slot;
+        i    = cowFind(node, n, 0);
+        n   -= cowBase(node, i);
+        slot = &node->child[i];
+    }
+    ((struct cowChunk*) *slot)->v[n] = val;
+    return 1;
+}
+
+size_t cowListLength(CowList list)
+{
+    return list->length;
+}
+
+void cowListForeach(CowList list, void (*fun)(void*, void*), void* arg)
+{
+    if (list->root)
+        cowForeachIn(list->root, list->height, fun, arg);
+}
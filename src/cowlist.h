@@ -0,0 +1,54 @@
+/* File: cowlist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _COWLIST_H_
+#define _COWLIST_H_
+
+#include <stddef.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct cowList* CowList;
+
+CowList cowListInit      (void);
+CowList cowListFromList  (List source);
+CowList cowListSnapshot  (CowList list);
+void    cowListFree      (CowList list);
+
+int     cowListPushBack  (CowList list, void* val);
+int     cowListPushFront (CowList list, void* val);
+int     cowListInsert    (CowList list, size_t n, void* val);
+void*   cowListPopBack   (CowList list);
+void*   cowListPopFront  (CowList list);
+int     cowListRemoveN   (CowList list, size_t n);
+
+void*   cowListGet       (CowList list, size_t n);
+int     cowListSet       (CowList list, size_t n, void* val);
+size_t  cowListLength    (CowList list);
+void    cowListForeach   (CowList list, void (*fun)(void*, void*), void* arg);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
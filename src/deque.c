@@ -0,0 +1,245 @@
+/* File: deque.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "deque.h"
+#include <stdlib.h>
+
+#define DEQUE_BLOCK 126         /* a block takes 1 KiB on 64-bit machines */
+
+struct dequeBlock
+{
+    struct dequeBlock* n;
+    struct dequeBlock* p;
+    void*              v[DEQUE_BLOCK];
+};
+
+/*
+ * The values occupy first->v[begin..] up to last->v[..end) and all the
+ * blocks in between. One emptied block is kept aside, so a deque going back
+ * and forth across a block boundary does not allocate every time.
+ */
+struct deque
+{
+    struct dequeBlock* first;
+    struct dequeBlock* last;
+    struct dequeBlock* spare;
+    size_t             begin;
+    size_t             end;
+    size_t             length;
+};
+
+static struct dequeBlock* dequeNewBlock(Deque deque)
+{
+    struct dequeBlock* block = deque->spare;
+    if (block)
+        deque->spare = NULL;
+    else
+        block = (struct dequeBlock*) malloc(sizeof(struct dequeBlock));
+    return block;
+}
+
+static void dequeDropBlock(Deque deque, struct dequeBlock* block)
+{
+    free(deque->spare);
+    deque->spare = block;
+}
+
+Deque dequeInit(void)
+{
+    Deque deque = (Deque) malloc(sizeof(struct deque));
+    if (deque == NULL)
+        return NULL;
+    deque->spare = NULL;
+    deque->first = deque->last = dequeNewBlock(deque);
+    if (deque->first == NULL)
+    {
+        free(deque);
+        return NULL;
+    }
+    deque->first->n = deque->first->p = NULL;
+    deque->begin  = deque->end = DEQUE_BLOCK / 2;
+    deque->length = 0;
+    return deque;
+}
+
+void dequeFree(Deque deque)
+{
+    struct dequeBlock* block;
+    if (deque == NULL)
+        return;
+    while ((block = deque->first))
+    {
+        deque->first = block->n;
+        free(block);
+    }
+    free(deque->spare);
+    free(deque);
+}
+
+void dequeFreeDeep(Deque deque)
+{
+    if (deque == NULL)
+        return;
+    while (deque->length)
+        free(dequePopFront(deque));
+    dequeFree(deque);
+}
+
+int dequePushBack(Deque deque, void* val)
+{
+    if (deque->end == DEQUE_BLOCK)
+    {
+        struct dequeBlock* block = dequeNewBlock(deque);
+        if (block == NULL)
+            return 0;
+        block->p       = deque->last;
+        block->n       = NULL;
+        deque->last->n = block;
+        deque->last    = block;
+        deque->end     = 0;
+    }
+    deque->last->v[deque->end++] = val;
+    ++deque->length;
+    return 1;
+}
+
+int dequePushFront(Deque deque, void* val)
+{
+    if (deque->begin == 0)
+    {
+        struct dequeBlock* block = dequeNewBlock(deque);
+        if (block == NULL)
+            return 0;
+        block->n        = deque->first;
+        block->p        = NULL;
+        deque->first->p = block;
+        deque->first    = block;
+        deque->begin    = DEQUE_BLOCK;
+    }
+    deque->first->v[--deque->begin] = val;
+    ++deque->length;
+    return 1;
+}
+
+/* recenters the single remaining block so both ends have room to grow */
+static void dequeRewind(Deque deque)
+{
+    if (deque->length == 0)
+        deque->begin = deque->end = DEQUE_BLOCK / 2;
+}
+
+void* dequePopBack(Deque deque)
+{
+    void* val;
+    if (deque->length == 0)
+        return NULL;
+    val = deque->last->v[--deque->end];
+    --deque->length;
+    if (deque->end == 0 && deque->first != deque->last)
+    {
+        struct dequeBlock* block = deque->last;
+        deque->last    = block->p;
+        deque->last->n = NULL;
+        deque->end     = DEQUE_BLOCK;
+        dequeDropBlock(deque, block);
+    }
+    dequeRewind(deque);
+    return val;
+}
+
+void* dequePopFront(Deque deque)
+{
+    void* val;
+    if (deque->length == 0)
+        return NULL;
+    val = deque->first->v[deque->begin++];
+    --deque->length;
+    if (deque->begin == DEQUE_BLOCK && deque->first != deque->last)
+    {
+        struct dequeBlock* block = deque->first;
+        deque->first    = block->n;
+        deque->first->p = NULL;
+        deque->begin    = 0;
+        dequeDropBlock(deque, block);
+    }
+    dequeRewind(deque);
+    return val;
+}
+
+void* dequeBack(Deque deque)
+{
+    return deque->length ? deque->last->v[deque->end - 1] : NULL;
+}
+
+void* dequeFront(Deque deque)
+{
+    return deque->length ? deque->first->v[deque->begin] : NULL;
+}
+
+size_t dequeLength(Deque deque)
+{
+    return deque->length;
+}
+
+int dequeIsEmpty(Deque deque)
+{
+    return deque->length == 0;
+}
+
+void dequeEmpty(Deque deque)
+{
+    while (deque->first != deque->last)
+    {
+        struct dequeBlock* block = deque->first;
+        deque->first = block->n;
+        dequeDropBlock(deque, block);
+    }
+    deque->first->p = NULL;
+    deque->length   = 0;
+    dequeRewind(deque);
+}
+
+void dequeBegin(Deque deque, DequeCursor* cursor)
+{
+    cursor->deque = deque;
+    cursor->block = deque->first;
+    cursor->i     = deque->begin;
+}
+
+int dequeNext(DequeCursor* cursor, void** val)
+{
+    Deque deque = cursor->deque;
+    if (cursor->block == deque->last && cursor->i == deque->end)
+        return 0;               /* the end */
+    if (cursor->i == DEQUE_BLOCK)
+    {
+        cursor->block = cursor->block->n;
+        cursor->i     = 0;
+    }
+    *val = cursor->block->v[cursor->i++];
+    return 1;
+}
+
+void dequeForeach(Deque deque, void (*fun)(void*, void*), void* arg)
+{
+    DequeCursor cursor;
+    void*       val;
+    dequeBegin(deque, &cursor);
+    while (dequeNext(&cursor, &val))
+        fun(val, arg);
+}
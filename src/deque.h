@@ -0,0 +1,62 @@
+/* File: deque.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _DEQUE_H_
+#define _DEQUE_H_
+
+#include <stddef.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct deque* Deque;
+
+typedef struct dequeCursor
+{
+    Deque               deque;
+    struct dequeBlock*  block;
+    size_t              i;
+} DequeCursor;
+
+Deque  dequeInit      (void);
+void   dequeFree      (Deque deque);
+void   dequeFreeDeep  (Deque deque);
+
+int    dequePushBack  (Deque deque, void* val);
+int    dequePushFront (Deque deque, void* val);
+void*  dequePopBack   (Deque deque);
+void*  dequePopFront  (Deque deque);
+void*  dequeBack      (Deque deque);
+void*  dequeFront     (Deque deque);
+
+size_t dequeLength    (Deque deque);
+int    dequeIsEmpty   (Deque deque);
+void   dequeEmpty     (Deque deque);
+
+void   dequeBegin     (Deque deque, DequeCursor* cursor);
+int    dequeNext      (DequeCursor* cursor, void** val);
+void   dequeForeach   (Deque deque, void (*fun)(void*, void*), void* arg);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
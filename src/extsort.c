@@ -0,0 +1,377 @@
+/* File: extsort.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "extsort.h"
+#include <stdlib.h>
+
+#define EXTSORT_MAX_FANIN 256
+
+/*
+ * The values are gathered in a list until they take up the memory budget,
+ * then the list is sorted and written out as a run to a temporary file. The
+ * runs, together with the values still in memory, are merged with a binary
+ * heap of their heads. If there are more runs than the budget allows to read
+ * at once (two stdio buffers per run), groups of them are first merged into
+ * longer runs. Runs and equal values never swap places, so the sort is
+ * stable.
+ */
+struct extSort
+{
+    int          (*compare)(const void*, const void*);
+    ListSerializer serializer;
+    size_t         budget;
+    size_t         used;        /* estimated memory taken by the chunk */
+    List           chunk;       /* the values not spilled yet */
+    FILE**         runs;
+    size_t         nruns;
+    size_t         capacity;
+};
+
+/* a run or the chunk being merged */
+struct extSource
+{
+    FILE* run;                  /* NULL for the chunk */
+    void* head;                 /* the least value not merged yet */
+};
+
+/* where the merged values go */
+struct extTarget
+{
+    ExtSort sort;
+    List    list;
+    FILE*   run;
+};
+
+static void extDestroy(ExtSort sort, void* val)
+{
+    if (sort->serializer.destroy)
+        sort->serializer.destroy(val, sort->serializer.ctx);
+}
+
+static size_t extCost(ExtSort sort, const void* val)
+{
+    size_t cost = sizeof(struct list);
+    if (sort->serializer.size)
+        cost += sort->serializer.size(val, sort->serializer.ctx);
+    return cost;
+}
+
+static int extAddRun(ExtSort sort, FILE* run)
+{
+    if (sort->nruns == sort->capacity)
+    {
+        size_t capacity = sort->capacity ? 2 * sort->capacity : 16;
+        FILE** runs     = (FILE**) realloc(sort->runs, capacity * sizeof(FILE*));
+        if (runs == NULL)
+            return 0;
+        sort->runs     = runs;
+        sort->capacity = capacity;
+    }
+    sort->runs[sort->nruns++] = run;
+    return 1;
+}
+
+/* reads the next head of the source, returns 0 on a read error */
+static int extAdvance(ExtSort sort, struct extSource* source)
+{
+    if (source->run == NULL)
+    {
+        source->head = listPopFront(sort->chunk);
+        return 1;
+    }
+    source->head = sort->serializer.read(source->run, sort->serializer.ctx);
+    return source->head || !ferror(source->run);
+}
+
+static int extLess(ExtSort sort, struct extSource* sources, size_t a, size_t b)
+{
+    int c = sort->compare(sources[a].head, sources[b].head);
+    return c < 0 || (c == 0 && a < b);
+}
+
+static void extSiftDown(ExtSort sort, struct extSource* sources, size_t* heap,
+                        size_t n, size_t i)
+{
+    size_t top = heap[i];
+    size_t child;
+    while ((child = 2 * i + 1) < n)
+    {
+        if (child + 1 < n && extLess(sort, sources, heap[child + 1], heap[child]))
+            ++child;
+        if (!extLess(sort, sources, heap[child], top))
+            break;
+        heap[i] = heap[child];
+        i       = child;
+    }
+    heap[i] = top;
+}
+
+/*
+ * Merges the runs, and the chunk too if withChunk is set, passing the values
+ * in order to fun, which takes their ownership. Stops when fun returns 0.
+ */
+static int extMerge(ExtSort sort, FILE** runs, size_t nruns, int withChunk,
+                    int (*fun)(void*, void*), void* arg)
+{
+    size_t            nsources = nruns + (withChunk ? 1 : 0);
+    struct extSource* sources;
+    size_t*           heap;
+    size_t            n = 0;
+    size_t            i;
+    int               result = 1;
+
+    sources = (struct extSource*) malloc(nsources * sizeof(struct extSource) + 1);
+    heap    = (size_t*) malloc(nsources * sizeof(size_t) + 1);
+    if (sources == NULL || heap == NULL)
+    {
+        free(sources);
+        free(heap);
+        return 0;
+    }
+
+    for (i = 0; i < nsources; ++i)
+    {
+        sources[i].run  = i < nruns ? runs[i] : NULL;
+        sources[i].head = NULL;
+        if (sources[i].run)
+            rewind(sources[i].run);
+        if (!extAdvance(sort, &sources[i]))
+            result = 0;
+        if (sources[i].head)
+            heap[n++] = i;
+    }
+    for (i = n / 2; i-- > 0;)
+        extSiftDown(sort, sources, heap, n, i);
+
+    while (result && n > 0)
+    {
+        struct extSource* top = &sources[heap[0]];
+        void*             val = top->head;
+        top->head = NULL;
+        if (!fun(val, arg) || !extAdvance(sort, top))
+            result = 0;
+        else
+        {
+            if (top->head == NULL)
+                heap[0] = heap[--n];
+            extSiftDown(sort, sources, heap, n, 0);
+        }
+    }
+
+    for (i = 0; i < nsources; ++i)
+        if (sources[i].head)
+            extDestroy(sort, sources[i].head);
+    free(sources);
+    free(heap);
+    return result;
+}
+
+static int extWriteRun(void* val, void* arg)
+{
+    struct extTarget* target = (struct extTarget*) arg;
+    int ok = target->sort->serializer.write(target->run, val,
+                                            target->sort->serializer.ctx);
+    extDestroy(target->sort, val);
+    return ok;
+}
+
+static int extAppend(void* val, void* arg)
+{
+    struct extTarget* target = (struct extTarget*) arg;
+    List place = listIsEmpty(target->list) ? target->list : listRBegin(target->list);
+    if (listAddAfter(target->list, place, val))
+        return 1;
+    extDestroy(target->sort, val);
+    return 0;
+}
+
+/* merges groups of runs until all of them can be read at once */
+static int extReduce(ExtSort sort)
+{
+    struct extTarget target;
+    size_t fanin = sort->budget / (2 * BUFSIZ);
+    size_t i, j, k, m;
+
+    if (fanin < 2)
+        fanin = 2;
+    if (fanin > EXTSORT_MAX_FANIN)
+        fanin = EXTSORT_MAX_FANIN;
+    target.sort = sort;
+
+    while (sort->nruns > fanin)
+    {
+        /* the merged runs are replaced in place, keeping their order */
+        for (i = 0, j = 0; i < sort->nruns; i += k, ++j)
+        {
+            k = sort->nruns - i < fanin ? sort->nruns - i : fanin;
+            if (k > 1)
+            {
+                target.run = tmpfile();
+                if (target.run == NULL
+                    || !extMerge(sort, sort->runs + i, k, 0, extWriteRun, &target)
+                    || fflush(target.run) != 0)
+                    break;
+                for (m = 0; m < k; ++m)
+                    fclose(sort->runs[i + m]);
+                sort->runs[j] = target.run;
+            }
+            else
+                sort->runs[j] = sort->runs[i];
+        }
+        if (i < sort->nruns)
+        {
+            /* keep the runs not merged yet */
+            if (target.run)
+                fclose(target.run);
+            for (m = i; m < sort->nruns; ++m)
+                sort->runs[j++] = sort->runs[m];
+            sort->nruns = j;
+            return 0;
+        }
+        sort->nruns = j;
+    }
+    return 1;
+}
+
+/* sorts the chunk and writes it out as a new run */
+static int extSpill(ExtSort sort)
+{
+    FILE* run = tmpfile();
+    List  it;
+    if (run == NULL)
+        return 0;
+    listSort(sort->chunk, sort->compare);
+    for (it = listBegin(sort->chunk); it; it = listNext(it))
+        if (!sort->serializer.write(run, it->v, sort->serializer.ctx))
+            break;
+    if (it || fflush(run) != 0 || !extAddRun(sort, run))
+    {
+        fclose(run);
+        return 0;
+    }
+
+    for (it = listBegin(sort->chunk); it; it = listNext(it))
+        extDestroy(sort, it->v);
+    listEmpty(sort->chunk);
+    sort->used = 0;
+
+    /* do not run out of file descriptors */
+    if (sort->nruns >= EXTSORT_MAX_FANIN)
+        return extReduce(sort);
+    return 1;
+}
+
+ExtSort extSortInit(int (*compare)(const void*, const void*),
+                    const ListSerializer* serializer, size_t budget)
+{
+    ExtSort sort = (ExtSort) malloc(sizeof(struct extSort));
+    if (sort == NULL)
+        return NULL;
+    sort->chunk = listInit();
+    if (sort->chunk == NULL)
+    {
+        free(sort);
+        return NULL;
+    }
+    sort->compare    = compare;
+    sort->serializer = *serializer;
+    sort->budget     = budget;
+    sort->used       = 0;
+    sort->runs       = NULL;
+    sort->nruns      = 0;
+    sort->capacity   = 0;
+    return sort;
+}
+
+void extSortFree(ExtSort sort)
+{
+    List it;
+    if (sort == NULL)
+        return;
+    for (it = listBegin(sort->chunk); it; it = listNext(it))
+        extDestroy(sort, it->v);
+    listFree(sort->chunk);
+    while (sort->nruns > 0)
+        fclose(sort->runs[--sort->nruns]);
+    free(sort->runs);
+    free(sort);
+}
+
+int extSortPush(ExtSort sort, void* val)
+{
+    List place = listIsEmpty(sort->chunk) ? sort->chunk : listRBegin(sort->chunk);
+    if (listAddAfter(sort->chunk, place, val) == NULL)
+        return 0;
+    sort->used += extCost(sort, val);
+    if (sort->used >= sort->budget)
+        return extSpill(sort);
+    return 1;
+}
+
+int extSortPushList(ExtSort sort, List list)
+{
+    while (!listIsEmpty(list))
+    {
+        listSpliceN(sort->chunk, list, 1);
+        sort->used += extCost(sort, listRBegin(sort->chunk)->v);
+        if (sort->used >= sort->budget && !extSpill(sort))
+            return 0;
+    }
+    return 1;
+}
+
+size_t extSortRuns(ExtSort sort)
+{
+    return sort->nruns;
+}
+
+int extSortToList(ExtSort sort, List out)
+{
+    struct extTarget target;
+    listSort(sort->chunk, sort->compare);
+    if (sort->nruns == 0)
+    {
+        listSplice(out, sort->chunk);
+        return 1;
+    }
+    target.sort = sort;
+    target.list = out;
+    return extReduce(sort)
+        && extMerge(sort, sort->runs, sort->nruns, 1, extAppend, &target);
+}
+
+int extSortForeach(ExtSort sort, int (*fun)(void*, void*), void* arg)
+{
+    listSort(sort->chunk, sort->compare);
+    return extReduce(sort)
+        && extMerge(sort, sort->runs, sort->nruns, 1, fun, arg);
+}
+
+int listSortExternal(List root, int (*compare)(const void*, const void*),
+                     const ListSerializer* serializer, size_t budget)
+{
+    ExtSort sort = extSortInit(compare, serializer, budget);
+    int     result;
+    if (sort == NULL)
+        return 0;
+    /* even if spilling fails, whatever got spilled is merged back */
+    result = extSortPushList(sort, root);
+    result = extSortToList(sort, root) && result;
+    extSortFree(sort);
+    return result;
+}
@@ -0,0 +1,62 @@
+/* File: extsort.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _EXTSORT_H_
+#define _EXTSORT_H_
+
+#include <stddef.h>
+#include <stdio.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+/* Tells the sorter how to spill the values to disk and read them back. */
+typedef struct listSerializer
+{
+    int    (*write)  (FILE* stream, const void* val, void* ctx);   /* 1 on success */
+    void*  (*read)   (FILE* stream, void* ctx);         /* NULL at the end */
+    size_t (*size)   (const void* val, void* ctx);      /* may be NULL */
+    void   (*destroy)(void* val, void* ctx);
+    void*    ctx;
+} ListSerializer;
+
+typedef struct extSort* ExtSort;
+
+ExtSort extSortInit      (int (*compare)(const void*, const void*),
+                          const ListSerializer* serializer, size_t budget);
+void    extSortFree      (ExtSort sort);
+
+int     extSortPush      (ExtSort sort, void* val);
+int     extSortPushList  (ExtSort sort, List list);
+size_t  extSortRuns      (ExtSort sort);
+
+int     extSortToList    (ExtSort sort, List out);
+int     extSortForeach   (ExtSort sort, int (*fun)(void*, void*), void* arg);
+
+int     listSortExternal (List root, int (*compare)(const void*, const void*),
+                          const ListSerializer* serializer, size_t budget);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
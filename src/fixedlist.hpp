@@ -0,0 +1,54 @@
+/* File: fixedlist.hpp */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _FIXEDLIST_HPP_
+#define _FIXEDLIST_HPP_
+
+#include <cstddef>
+#include "list.h"
+
+/* A list of up to N elements kept inside the object itself, so it never
+ * allocates. It converts to List, so all the list functions work on it. */
+template <std::size_t N>
+class FixedList
+{
+public:
+    static const std::size_t capacity = N;
+
+    FixedList()  : root(listInitFixed(buffer, sizeof(buffer))) {}
+    ~FixedList() { listFree(root); }
+
+    operator List() const { return root; }
+
+    bool  pushBack  (void* val) { return listPushBack(root, val) != 0; }
+    bool  pushFront (void* val) { return listPushFront(root, val) != 0; }
+    void* popBack   ()          { return listPopBack(root); }
+    void* popFront  ()          { return listPopFront(root); }
+    bool  empty     () const    { return listIsEmpty(root) != 0; }
+    std::size_t size() const    { return listSize(root); }
+
+private:
+    /* the root points into the buffer */
+    FixedList(const FixedList&);
+    FixedList& operator=(const FixedList&);
+
+    struct list buffer[LIST_FIXED_SLOTS(N)];
+    List        root;
+};
+
+#endif
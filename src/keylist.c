@@ -0,0 +1,346 @@
+/* File: keylist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "keylist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KEYLIST_X86
+#include <immintrin.h>
+#endif
+
+#define KEY_CHUNK 64
+
+/*
+ * The keys of a chunk are stored next to each other, apart from the values,
+ * so they can be compared several at a time with SIMD instructions.
+ */
+struct keyChunk
+{
+    struct keyChunk* n;
+    struct keyChunk* p;
+    size_t           count;
+    int64_t          keys[KEY_CHUNK];
+    void*            vals[KEY_CHUNK];
+};
+
+/* returns the index of the first key equal to key in [from, count) or count */
+typedef size_t (*keyScanFn) (const int64_t* keys, size_t from, size_t count, int64_t key);
+/* returns the number of keys equal to key in [0, count) */
+typedef size_t (*keyCountFn)(const int64_t* keys, size_t count, int64_t key);
+
+struct keyList
+{
+    struct keyChunk* first;
+    struct keyChunk* last;
+    size_t           length;
+    keyScanFn        scan;
+    keyCountFn       count;
+};
+
+static size_t keyScanScalar(const int64_t* keys, size_t from, size_t count, int64_t key)
+{
+    for (; from < count && keys[from] != key; ++from)
+        ;
+    return from;
+}
+
+static size_t keyCountScalar(const int64_t* keys, size_t count, int64_t key)
+{
+    size_t i, found = 0;
+    for (i = 0; i < count; ++i)
+        found += keys[i] == key;
+    return found;
+}
+
+#if defined(KEYLIST_X86) && defined(__SSE2__)
+/* SSE2 has no 64-bit comparison, both halves have to match */
+static unsigned keyEqSse2(__m128i a, __m128i b)
+{
+    __m128i e = _mm_cmpeq_epi32(a, b);
+    e = _mm_and_si128(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_movemask_pd(_mm_castsi128_pd(e));
+}
+
+/* 8 keys per iteration */
+static unsigned keyMaskSse2(const int64_t* keys, __m128i needle)
+{
+    const __m128i* v = (const __m128i*) keys;
+    return  keyEqSse2(_mm_loadu_si128(v),     needle)
+         | (keyEqSse2(_mm_loadu_si128(v + 1), needle) << 2)
+         | (keyEqSse2(_mm_loadu_si128(v + 2), needle) << 4)
+         | (keyEqSse2(_mm_loadu_si128(v + 3), needle) << 6);
+}
+
+static size_t keyScanSse2(const int64_t* keys, size_t from, size_t count, int64_t key)
+{
+    __m128i needle = _mm_set1_epi64x(key);
+    for (; from + 8 <= count; from += 8)
+    {
+        unsigned mask = keyMaskSse2(keys + from, needle);
+        if (mask)
+            return from + __builtin_ctz(mask);
+    }
+    return keyScanScalar(keys, from, count, key);
+}
+
+static size_t keyCountSse2(const int64_t* keys, size_t count, int64_t key)
+{
+    __m128i needle = _mm_set1_epi64x(key);
+    size_t  i, found = 0;
+    for (i = 0; i + 8 <= count; i += 8)
+        found += __builtin_popcount(keyMaskSse2(keys + i, needle));
+    return found + keyCountScalar(keys + i, count - i, key);
+}
+#endif
+
+#ifdef KEYLIST_X86
+/* 16 keys per iteration */
+__attribute__((target("avx2")))
+static size_t keyScanAvx2(const int64_t* keys, size_t from, size_t count, int64_t key)
+{
+    __m256i needle = _mm256_set1_epi64x(key);
+    for (; from + 16 <= count; from += 16)
+    {
+        const __m256i* v = (const __m256i*) (keys + from);
+        unsigned mask =
+              _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256(v),     needle)))
+            | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256(v + 1), needle))) << 4
+            | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256(v + 2), needle))) << 8
+            | _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_loadu_si256(v + 3), needle))) << 12;
+        if (mask)
+            return from + __builtin_ctz(mask);
+    }
+    return keyScanScalar(keys, from, count, key);
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t keyCountAvx2(const int64_t* keys, size_t count, int64_t key)
+{
+    __m256i needle = _mm256_set1_epi64x(key);
+    size_t  i, found = 0;
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        const __m256i* v = (const __m256i*) (keys + i);
+        __m256i a = _mm256_cmpeq_epi64(_mm256_loadu_si256(v),     needle);
+        __m256i b = _mm256_cmpeq_epi64(_mm256_loadu_si256(v + 1), needle);
+        __m256i c = _mm256_cmpeq_epi64(_mm256_loadu_si256(v + 2), needle);
+        __m256i d = _mm256_cmpeq_epi64(_mm256_loadu_si256(v + 3), needle);
+        found += __builtin_popcount(
+              _mm256_movemask_pd(_mm256_castsi256_pd(a))
+            | _mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4
+            | _mm256_movemask_pd(_mm256_castsi256_pd(c)) << 8
+            | _mm256_movemask_pd(_mm256_castsi256_pd(d)) << 12);
+    }
+    return found + keyCountScalar(keys + i, count - i, key);
+}
+#endif
+
+int keyListUseSimd(KeyList list, int level)
+{
+#ifdef KEYLIST_X86
+    __builtin_cpu_init();
+    if (level >= KEYLIST_AVX2 && __builtin_cpu_supports("avx2"))
+    {
+        list->scan  = keyScanAvx2;
+        list->count = keyCountAvx2;
+        return KEYLIST_AVX2;
+    }
+#endif
+#if defined(KEYLIST_X86) && defined(__SSE2__)
+    if (level >= KEYLIST_SSE2)
+    {
+        list->scan  = keyScanSse2;
+        list->count = keyCountSse2;
+        return KEYLIST_SSE2;
+    }
+#endif
+    (void) level;
+    list->scan  = keyScanScalar;
+    list->count = keyCountScalar;
+    return KEYLIST_SCALAR;
+}
+
+KeyList keyListInit(void)
+{
+    KeyList list = (KeyList) malloc(sizeof(struct keyList));
+    if (list == NULL)
+        return NULL;
+    list->first  = NULL;
+    list->last   = NULL;
+    list->length = 0;
+    keyListUseSimd(list, KEYLIST_AVX2);
+    return list;
+}
+
+void keyListFree(KeyList list)
+{
+    struct keyChunk* chunk;
+    if (list == NULL)
+        return;
+    while ((chunk = list->first))
+    {
+        list->first = chunk->n;
+        free(chunk);
+    }
+    free(list);
+}
+
+/* links a new chunk after place, or at the front if place is NULL */
+static struct keyChunk* keyNewChunk(KeyList list, struct keyChunk* place)
+{
+    struct keyChunk* chunk = (struct keyChunk*) malloc(sizeof(struct keyChunk));
+    if (chunk == NULL)
+        return NULL;
+    chunk->count = 0;
+    chunk->p     = place;
+    chunk->n     = place ? place->n : list->first;
+    if (chunk->n)
+        chunk->n->p = chunk;
+    else
+        list->last  = chunk;
+    if (place)
+        place->n    = chunk;
+    else
+        list->first = chunk;
+    return chunk;
+}
+
+static void keyDropChunk(KeyList list, struct keyChunk* chunk)
+{
+    if (chunk->p)
+        chunk->p->n = chunk->n;
+    else
+        list->first = chunk->n;
+    if (chunk->n)
+        chunk->n->p = chunk->p;
+    else
+        list->last  = chunk->p;
+    free(chunk);
+}
+
+int keyListPushBack(KeyList list, int64_t key, void* val)
+{
+    struct keyChunk* chunk = list->last;
+    if ((chunk == NULL || chunk->count == KEY_CHUNK)
+        && (chunk = keyNewChunk(list, list->last)) == NULL)
+        return 0;
+    chunk->keys[chunk->count] = key;
+    chunk->vals[chunk->count] = val;
+    ++chunk->count;
+    ++list->length;
+    return 1;
+}
+
+int keyListPushFront(KeyList list, int64_t key, void* val)
+{
+    struct keyChunk* chunk = list->first;
+    if ((chunk == NULL || chunk->count == KEY_CHUNK)
+        && (chunk = keyNewChunk(list, NULL)) == NULL)
+        return 0;
+    memmove(chunk->keys + 1, chunk->keys, chunk->count * sizeof(int64_t));
+    memmove(chunk->vals + 1, chunk->vals, chunk->count * sizeof(void*));
+    chunk->keys[0] = key;
+    chunk->vals[0] = val;
+    ++chunk->count;
+    ++list->length;
+    return 1;
+}
+
+int keyListFind(KeyList list, int64_t key, void** val)
+{
+    struct keyChunk* chunk;
+    for (chunk = list->first; chunk; chunk = chunk->n)
+    {
+        size_t i = list->scan(chunk->keys, 0, chunk->count, key);
+        if (i < chunk->count)
+        {
+            if (val)
+                *val = chunk->vals[i];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+size_t keyListCount(KeyList list, int64_t key)
+{
+    struct keyChunk* chunk;
+    size_t           found = 0;
+    for (chunk = list->first; chunk; chunk = chunk->n)
+        found += list->count(chunk->keys, chunk->count, key);
+    return found;
+}
+
+size_t keyListRemoveKey(KeyList list, int64_t key)
+{
+    struct keyChunk* chunk = list->first;
+    struct keyChunk* next;
+    size_t           removed = 0;
+
+    for (; chunk; chunk = next)
+    {
+        size_t r, w = list->scan(chunk->keys, 0, chunk->count, key);
+        next = chunk->n;
+        if (w == chunk->count)
+            continue;
+        /* compact the rest of the chunk */
+        for (r = w + 1; r < chunk->count; ++r)
+            if (chunk->keys[r] != key)
+            {
+                chunk->keys[w] = chunk->keys[r];
+                chunk->vals[w] = chunk->vals[r];
+                ++w;
+            }
+        removed      += chunk->count - w;
+        chunk->count  = w;
+        if (w == 0)
+            keyDropChunk(list, chunk);
+    }
+    list->length -= removed;
+    return removed;
+}
+
+size_t keyListLength(KeyList list)
+{
+    return list->length;
+}
+
+void keyListBegin(KeyList list, KeyCursor* cursor)
+{
+    cursor->chunk = list->first;
+    cursor->i     = 0;
+}
+
+int keyListNext(KeyCursor* cursor, int64_t* key, void** val)
+{
+    if (cursor->chunk && cursor->i == cursor->chunk->count)
+    {
+        cursor->chunk = cursor->chunk->n;
+        cursor->i     = 0;
+    }
+    if (cursor->chunk == NULL)
+        return 0;               /* the end */
+    if (key)
+        *key = cursor->chunk->keys[cursor->i];
+    if (val)
+        *val = cursor->chunk->vals[cursor->i];
+    ++cursor->i;
+    return 1;
+}
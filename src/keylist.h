@@ -0,0 +1,65 @@
+/* File: keylist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _KEYLIST_H_
+#define _KEYLIST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+/* instruction sets for keyListUseSimd, from the slowest one */
+enum
+{
+    KEYLIST_SCALAR,
+    KEYLIST_SSE2,
+    KEYLIST_AVX2
+};
+
+typedef struct keyList* KeyList;
+
+typedef struct keyCursor
+{
+    struct keyChunk* chunk;
+    size_t           i;
+} KeyCursor;
+
+KeyList keyListInit      (void);
+void    keyListFree      (KeyList list);
+int     keyListUseSimd   (KeyList list, int level);
+
+int     keyListPushBack  (KeyList list, int64_t key, void* val);
+int     keyListPushFront (KeyList list, int64_t key, void* val);
+int     keyListFind      (KeyList list, int64_t key, void** val);
+size_t  keyListCount     (KeyList list, int64_t key);
+size_t  keyListRemoveKey (KeyList list, int64_t key);
+size_t  keyListLength    (KeyList list);
+
+void    keyListBegin     (KeyList list, KeyCursor* cursor);
+int     keyListNext      (KeyCursor* cursor, int64_t* key, void** val);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -16,71 +16,325 @@
 /* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
 /*************************************************************************/
 
-#include "list.h"
+#ifdef LIST_STATS
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "listmeta.h"
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef LIST_STATS
+#include <time.h>
+#endif
+
+static void* listDefaultAlloc(size_t size, void* ctx)
+{
+    (void) ctx;
+    return malloc(size);
+}
+
+static void listDefaultFree(void* ptr, void* ctx)
+{
+    (void) ctx;
+    free(ptr);
+}
+
+static const ListAllocator listDefaultAllocator =
+    { listDefaultAlloc, listDefaultFree, NULL };
+
+#define listMetaOf(A) ((A)->isRoot ? (struct listMeta*) (A)->v : NULL)
+
+#ifdef LIST_STATS
+/* shared by all the threads, so only updated with the atomic STAT_ADD */
+static ListStats globalStats;
+
+#define STAT_ADD(A, k) __atomic_add_fetch(&(A), (k), __ATOMIC_RELAXED)
+
+static ListStats* listStatsOf(List root)
+{
+    struct listMeta* meta = root ? listMetaOf(root) : NULL;
+    return meta ? meta->stats : NULL;
+}
+
+static void listStatRecord(List root, int op, unsigned long nodes,
+                           const struct timespec* start)
+{
+    ListStats*      stats  = listStatsOf(root);
+    struct timespec end;
+    unsigned long   ns;
+    int             bucket = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = (end.tv_sec - start->tv_sec) * 1000000000UL + end.tv_nsec - start->tv_nsec;
+    while (ns >>= 1)
+        ++bucket;
+    if (bucket >= LIST_STAT_BUCKETS)
+        bucket = LIST_STAT_BUCKETS - 1;
+
+    STAT_ADD(globalStats.calls[op], 1);
+    STAT_ADD(globalStats.traversed[op], nodes);
+    STAT_ADD(globalStats.latency[op][bucket], 1);
+    if (stats)
+    {
+        ++stats->calls[op];
+        stats->traversed[op] += nodes;
+        ++stats->latency[op][bucket];
+    }
+}
+
+#define STAT_DECLARE               struct timespec statStart_; unsigned long statNodes_ = 0;
+#define STAT_START()               clock_gettime(CLOCK_MONOTONIC, &statStart_)
+#define STAT_STOP(root, op)        listStatRecord(root, op, statNodes_, &statStart_)
+#define STAT_NODE()                (++statNodes_)
+#define STAT_COUNT(root, field, k)                                   \
+    (STAT_ADD(globalStats.field, k),                                 \
+     listStatsOf(root) ? (void) (listStatsOf(root)->field += (k)) : (void) 0)
+#else
+#define STAT_DECLARE
+#define STAT_START()               ((void) 0)
+#define STAT_STOP(root, op)        ((void) 0)
+#define STAT_NODE()                ((void) 0)
+#define STAT_COUNT(root, field, k) ((void) 0)
+#endif
+
+static List listNodeAlloc(List root)
+{
+    struct listMeta* meta = listMetaOf(root);
+    STAT_COUNT(root, allocs, 1);
+    if (meta)
+        return (List) meta->allocator.alloc(sizeof(struct list), meta->allocator.ctx);
+    return newListNode();
+}
+
+static void listNodeFree(List root, List node)
+{
+    struct listMeta* meta = root ? listMetaOf(root) : NULL;
+    STAT_COUNT(root, frees, 1);
+    if (meta)
+        meta->allocator.free(node, meta->allocator.ctx);
+    else
+        free(node);
+}
+
+/* frees the chain of nodes starting at first, which must not be the root */
+static void listFreeChain(List root, List first, int deep)
+{
+    struct listMeta* meta = root ? listMetaOf(root) : NULL;
+    List it1 = first;
+    List it2;
+    while (it1 != NULL)
+    {
+        it2 = it1;
+        it1 = listNext(it1);
+        if (deep)
+        {
+            if (meta)
+                meta->allocator.free(it2->v, meta->allocator.ctx);
+            else
+                free(it2->v);
+        }
+        listNodeFree(root, it2);
+    }
+}
 
 List listInit(void)
 {
+#ifdef LIST_STATS
+    return listInitWithAllocator(&listDefaultAllocator);
+#else
     List root = newListNode();
 
     root->isRoot = 1;
+    root->v      = NULL;
     root->n      = NULL;
     root->p      = NULL;
     return root;
+#endif
 }
 
-void listFree(List root)
+List listInitWithAllocator(const ListAllocator* allocator)
 {
-    List it1 = root;
-    List it2;
-    while (it1 != NULL)
+    struct listMeta* meta;
+    List             root;
+    size_t           size = sizeof(struct listMeta);
+
+    if (allocator == NULL)
+        allocator = &listDefaultAllocator;
+#ifdef LIST_STATS
+    size += sizeof(ListStats);
+#endif
+
+    root = (List) allocator->alloc(sizeof(struct list), allocator->ctx);
+    if (root == NULL)
+        return NULL;
+    meta = (struct listMeta*) allocator->alloc(size, allocator->ctx);
+    if (meta == NULL)
     {
-        it2 = it1;
-        it1 = listNext(it1);
-        free(it2);
+        allocator->free(root, allocator->ctx);
+        return NULL;
     }
+
+    listInitPlaced(root, meta, allocator, (ListStats*) (meta + 1));
+    meta->placed = 0;
+    STAT_COUNT(root, allocs, 1);
+    return root;
 }
 
-void listFreeDeep(List root)
+void listInitPlaced(List root, struct listMeta* meta,
+                    const ListAllocator* allocator, ListStats* stats)
 {
-    List it1 = root;
-    List it2;
-    while (it1 != NULL)
+    meta->allocator = *allocator;
+    meta->stats     = NULL;
+    meta->placed    = 1;
+#ifdef LIST_STATS
+    meta->stats     = stats;
+    if (stats)
+        memset(stats, 0, sizeof(ListStats));
+#else
+    (void) stats;
+#endif
+
+    root->isRoot = 1;
+    root->v      = meta;
+    root->n      = NULL;
+    root->p      = NULL;
+}
+
+/*
+ * A fixed-capacity list lives in a buffer of LIST_FIXED_SLOTS(N) nodes: this
+ * header takes the first LIST_FIXED_OVERHEAD of them and the rest are handed
+ * out by its allocator, which never calls malloc. Anything it is asked to free
+ * outside the buffer can only be a value, so it goes to free.
+ */
+struct listFixed
+{
+    struct list     root;
+    struct listMeta meta;
+    List            free;       /* chain of the freed nodes */
+    List            next;       /* the first node never used */
+    List            end;
+};
+
+/* fails to compile if the header does not fit in LIST_FIXED_OVERHEAD nodes */
+typedef char listFixedFits[sizeof(struct listFixed)
+                           <= LIST_FIXED_OVERHEAD * sizeof(struct list) ? 1 : -1];
+
+static void* listFixedAlloc(size_t size, void* ctx)
+{
+    struct listFixed* fixed = (struct listFixed*) ctx;
+    List              node  = fixed->free;
+    if (size > sizeof(struct list))
+        return NULL;
+    if (node)
     {
-        it2 = it1;
-        it1 = listNext(it1);
-        free(it2->v);
-        free(it2);
+        fixed->free = node->n;
+        return node;
+    }
+    if (fixed->next == fixed->end)
+        return NULL;            /* the list is full */
+    return fixed->next++;
+}
+
+static void listFixedFree(void* ptr, void* ctx)
+{
+    struct listFixed* fixed = (struct listFixed*) ctx;
+    List              node  = (List) ptr;
+    if (node < (List) fixed || node >= fixed->end)
+    {
+        free(ptr);              /* a value freed by listFreeDeep */
+        return;
+    }
+    if (node < (List) fixed + LIST_FIXED_OVERHEAD)
+        return;                 /* the root or its private data */
+    node->n     = fixed->free;
+    fixed->free = node;
+}
+
+List listInitFixed(void* buffer, size_t size)
+{
+    struct listFixed* fixed = (struct listFixed*) buffer;
+    ListAllocator     allocator;
+
+    if (size < LIST_FIXED_OVERHEAD * sizeof(struct list))
+        return NULL;
+    allocator.alloc = listFixedAlloc;
+    allocator.free  = listFixedFree;
+    allocator.ctx   = fixed;
+    fixed->free     = NULL;
+    fixed->next     = (List) buffer + LIST_FIXED_OVERHEAD;
+    fixed->end      = (List) buffer + size / sizeof(struct list);
+
+    listInitPlaced(&fixed->root, &fixed->meta, &allocator, NULL);
+    return &fixed->root;
+}
+
+static void listFreeRoot(List root, int deep)
+{
+    struct listMeta* meta;
+    if (root == NULL)
+        return;
+    if (!root->isRoot)
+    {
+        /* freeing a detached chain of nodes */
+        listFreeChain(NULL, root, deep);
+        return;
     }
+    listFreeChain(root, root->n, deep);
+
+    meta = listMetaOf(root);
+    if (meta == NULL || !meta->placed)
+        STAT_COUNT(root, frees, 1);
+    if (meta)
+    {
+        ListAllocator allocator = meta->allocator;
+        allocator.free(meta, allocator.ctx);
+        allocator.free(root, allocator.ctx);
+    }
+    else
+        free(root);
+}
+
+void listFree(List root)
+{
+    listFreeRoot(root, 0);
 }
 
-void listPushBack(List root, void* val)
+void listFreeDeep(List root)
+{
+    listFreeRoot(root, 1);
+}
+
+int listPushBack(List root, void* val)
 {
-    listAddAfter(root,
-                 listIsEmpty(root) ? root : listRBegin(root),
-                 val);
+    return listAddAfter(root,
+                        listIsEmpty(root) ? root : listRBegin(root),
+                        val) != NULL;
 }
 
-void listPushFront(List root, void* val)
+int listPushFront(List root, void* val)
 {
-    listAddAfter(root, root, val);
+    return listAddAfter(root, root, val) != NULL;
 }
 
-void listPushSort(List root, void* val, int (*compare)(const void*, const void*))
+int listPushSort(List root, void* val, int (*compare)(const void*, const void*))
 {
     /* compare should return -1 on lesser, 0 on equal and 1 on greater */
     List iterator = root;
-    while (iterator->n && compare(iterator->n->v, val) < 0)
+    List element;
+    STAT_DECLARE
+    STAT_START();
+    while (iterator->n && (STAT_NODE(), STAT_COUNT(root, compares, 1),
+                           compare(iterator->n->v, val) < 0))
         iterator = listNext(iterator);
-    listAddAfter(root, iterator, val);
+    element = listAddAfter(root, iterator, val);
+    STAT_STOP(root, LIST_OP_PUSHSORT);
+    return element != NULL;
 }
 
-List listAddAfter(List root, List place, void* val)
+/* links an already allocated node after place */
+static void listLinkAfter(List root, List place, List ptr)
 {
-    List ptr;
-    ptr             = newListNode();
-    ptr->isRoot     = 0;
-    ptr->v          = val;
     ptr->n          = place->n;
     if (!place->isRoot)
         ptr->p      = place;
@@ -92,42 +346,116 @@ List listAddAfter(List root, List place, void* val)
 
     if (ptr->n == NULL)
         root->p = ptr;
+}
+
+/* detaches the node from the list without freeing it */
+static void listUnlink(List root, List element)
+{
+    if (root->n == element)
+        root->n       = element->n;
+    if (element->p)
+        element->p->n = element->n;
+    if (element->n)
+        element->n->p = element->p;
+    else
+        root->p = element->p;
+}
+
+/* moves all the nodes of src to the end of root */
+static void listAppendChain(List root, List src)
+{
+    if (src->n == NULL)
+        return;
+    if (root->n == NULL)
+        root->n    = src->n;
+    else
+    {
+        root->p->n = src->n;
+        src->n->p  = root->p;
+    }
+    root->p = src->p;
+    src->n  = NULL;
+    src->p  = NULL;
+}
+
+void listLinkNode(List root, List place, List element)
+{
+    element->isRoot = 0;
+    listLinkAfter(root, place, element);
+}
+
+void listUnlinkNode(List root, List element)
+{
+    listUnlink(root, element);
+}
 
+List listAddAfter(List root, List place, void* val)
+{
+    List ptr;
+    STAT_DECLARE
+    STAT_START();
+    ptr             = listNodeAlloc(root);
+    if (ptr == NULL)
+        return NULL;
+    ptr->isRoot     = 0;
+    ptr->v          = val;
+    listLinkAfter(root, place, ptr);
+    STAT_STOP(root, LIST_OP_ADD);
     return ptr;
 }
 
 List listGet(List root, int n)
 {
-    int i;
+    List element = root;
+    int  i;
+    STAT_DECLARE
+    STAT_START();
     for (i = 0; i <= n; ++i)    /* intentional apparent off-by-one! */
     {
-        root = listNext(root);
-        if (root == NULL)
-            return NULL;        /* out-of-list exception */
+        element = listNext(element);
+        if (element == NULL)
+            break;              /* out-of-list exception */
+        STAT_NODE();
     }
-    return root;
+    STAT_STOP(root, LIST_OP_GET);
+    return element;
 }
 
 /* compare should return -1 on lesser, 0 on equal and 1 on greater */
 List listGetVal(List root, void* val, int (*compare)(const void*, const void*))
 {
     List element = listBegin(root);
-    for (; element && element->v && compare(element->v, val) != 0; element = listNext(element))
+    STAT_DECLARE
+    STAT_START();
+    for (; element && element->v && (STAT_NODE(), STAT_COUNT(root, compares, 1),
+                                      compare(element->v, val) != 0);
+         element = listNext(element))
         ;
+    STAT_STOP(root, LIST_OP_GETVAL);
     return element;
 }
 
 void listRemove(List root, List element)
 {
-    if (root->n == element)
-        root->n       = element->n;
-    if (element->p)
-        element->p->n = element->n;
-    if (element->n)
-        element->n->p = element->p;
-    else
-        root->p = element->p;
-    free(element);
+    STAT_DECLARE
+    STAT_START();
+    listUnlink(root, element);
+    listNodeFree(root, element);
+    STAT_STOP(root, LIST_OP_REMOVE);
+}
+
+List listGetAt(List root, size_t n)
+{
+    List element = listBegin(root);
+    STAT_DECLARE
+    STAT_START();
+    for (; element && n > 0; --n)
+    {
+        element = listNext(element);
+        STAT_NODE();
+    }
+    STAT_STOP(root, LIST_OP_GET);
+    return element;
 }
 
 int listRemoveN(List root, int n)
@@ -139,6 +467,15 @@ int listRemoveN(List root, int n)
     return 1;
 }
 
+int listRemoveAt(List root, size_t n)
+{
+    List element = listGetAt(root, n);
+    if (element == NULL)
+        return 0;               /* out-of-list exception */
+    listRemove(root, element);
+    return 1;
+}
+
 /* compare should return -1 on lesser, 0 on equal and 1 on greater */
 int listRemoveVal(List root, void* val, int (*compare)(const void*, const void*))
 {
@@ -149,6 +486,241 @@ int listRemoveVal(List root, void* val, int (*compare)(const void*, const void*)
     return 1;
 }
 
+/* pred should return non-zero for the elements to remove */
+int listRemoveIf(List root, int (*pred)(const void*, void*), void* arg,
+                 void (*destroy)(void*))
+{
+    int  count = 0;
+    List element = listBegin(root);
+    List next;
+    for (; element; element = next)
+    {
+        next = listNext(element);
+        if (pred(element->v, arg))
+        {
+            if (destroy)
+                destroy(element->v);
+            listRemove(root, element);
+            ++count;
+        }
+    }
+    return count;
+}
+
+int listFilter(List root, List dest, int (*pred)(const void*, void*), void* arg)
+{
+    int  count = 0;
+    List element = listBegin(root);
+    List next;
+    for (; element; element = next)
+    {
+        next = listNext(element);
+        if (pred(element->v, arg))
+        {
+            listUnlink(root, element);
+            listLinkAfter(dest, listIsEmpty(dest) ? dest : listRBegin(dest), element);
+            ++count;
+        }
+    }
+    return count;
+}
+
+int listPartition(List root, int (*pred)(const void*, void*), void* arg)
+{
+    struct list restRoot;
+    List rest    = &restRoot;
+    int  count   = 0;
+    List element = listBegin(root);
+    List next;
+
+    rest->isRoot = 1;
+    rest->n      = NULL;
+    rest->p      = NULL;
+    for (; element; element = next)
+    {
+        next = listNext(element);
+        if (pred(element->v, arg))
+            ++count;
+        else
+        {
+            listUnlink(root, element);
+            listLinkAfter(rest, listIsEmpty(rest) ? rest : listRBegin(rest), element);
+        }
+    }
+    listAppendChain(root, rest);
+    return count;
+}
+
+void listMoveAfter(List root, List place, List element)
+{
+    if (place == element || place->n == element)
+        return;
+    listUnlink(root, element);
+    listLinkAfter(root, place, element);
+}
+
+void listMoveToFront(List root, List element)
+{
+    listMoveAfter(root, root, element);
+}
+
+void listMoveToBack(List root, List element)
+{
+    listMoveAfter(root, listRBegin(root), element);
+}
+
+/* unlinks and frees the node, destroying its value first */
+static void listDrop(List root, List element, void (*destroy)(void*))
+{
+    if (destroy)
+        destroy(element->v);
+    listUnlink(root, element);
+    listNodeFree(root, element);
+}
+
+#define listCompare(root, compare, a, b) \
+    (STAT_COUNT(root, compares, 1), compare((a)->v, (b)->v))
+
+/*
+ * The functions below expect both lists sorted with compare and walk them in
+ * lock-step. Equal elements are matched one to one, like in the multiset
+ * operations of the C++ STL. All of them return the number of dropped
+ * elements.
+ */
+size_t listUnion(List root, List other, int (*compare)(const void*, const void*),
+                 void (*destroy)(void*))
+{
+    size_t count = 0;
+    List   a     = listBegin(root);
+    List   b;
+    int    c;
+    while (a && (b = listBegin(other)))
+    {
+        c = listCompare(root, compare, a, b);
+        if (c < 0)
+            a = listNext(a);
+        else if (c > 0)
+        {
+            listUnlink(other, b);
+            listLinkAfter(root, a->p ? a->p : root, b);
+        }
+        else
+        {
+            a = listNext(a);
+            listDrop(other, b, destroy);
+            ++count;
+        }
+    }
+    listAppendChain(root, other);
+    return count;
+}
+
+size_t listIntersect(List root, List other, int (*compare)(const void*, const void*),
+                     void (*destroy)(void*))
+{
+    size_t count = 0;
+    List   a     = listBegin(root);
+    List   b     = listBegin(other);
+    List   next;
+    int    c;
+    while (a)
+    {
+        next = listNext(a);
+        c    = b ? listCompare(root, compare, a, b) : -1;
+        if (c < 0)
+        {
+            listDrop(root, a, destroy);
+            ++count;
+            a = next;
+        }
+        else if (c > 0)
+            b = listNext(b);
+        else
+        {
+            a = next;
+            b = listNext(b);
+        }
+    }
+    return count;
+}
+
+size_t listDifference(List root, List other, int (*compare)(const void*, const void*),
+                      void (*destroy)(void*))
+{
+    size_t count = 0;
+    List   a     = listBegin(root);
+    List   b     = listBegin(other);
+    List   next;
+    int    c;
+    while (a && b)
+    {
+        next = listNext(a);
+        c    = listCompare(root, compare, a, b);
+        if (c < 0)
+            a = next;
+        else if (c > 0)
+            b = listNext(b);
+        else
+        {
+            listDrop(root, a, destroy);
+            ++count;
+            a = next;
+            b = listNext(b);
+        }
+    }
+    return count;
+}
+
+size_t listUnique(List root, int (*compare)(const void*, const void*),
+                  void (*destroy)(void*))
+{
+    size_t count = 0;
+    List   element = listBegin(root);
+    List   next;
+    if (element == NULL)
+        return 0;
+    while ((next = listNext(element)))
+    {
+        if (listCompare(root, compare, next, element) == 0)
+        {
+            listDrop(root, next, destroy);
+            ++count;
+        }
+        else
+            element = next;
+    }
+    return count;
+}
+
+void listSplice(List root, List src)
+{
+    listAppendChain(root, src);
+}
+
+size_t listSpliceN(List root, List src, size_t n)
+{
+    struct list headRoot;
+    List   head  = &headRoot;
+    List   last  = src->n;
+    size_t moved = 1;
+
+    if (n == 0 || last == NULL)
+        return 0;
+    for (; moved < n && last->n; ++moved)
+        last = last->n;
+
+    head->n = src->n;
+    head->p = last;
+    src->n  = last->n;
+    if (src->n)
+        src->n->p = NULL;
+    else
+        src->p    = NULL;
+    last->n = NULL;
+    listAppendChain(root, head);
+    return moved;
+}
+
 int listLength(List root)
 {
     int i = 0;
@@ -161,6 +733,18 @@ int listLength(List root)
     return i;
 }
 
+size_t listSize(List root)
+{
+    size_t i = 0;
+    root = listNext(root);
+    while (root)
+    {
+        root = listNext(root);
+        ++i;
+    }
+    return i;
+}
+
 int listIsEmpty(List root)
 {
     return root->n == NULL;
@@ -168,7 +752,7 @@ int listIsEmpty(List root)
 
 void listEmpty(List root)
 {
-    listFree(root->n);
+    listFreeChain(root, root->n, 0);
     root->n = NULL;
     root->p = NULL;
 }
@@ -201,11 +785,28 @@ void* listPopFront(List root)
 
 List listCopy(List source)
 {
-    List copy = listInit();
-    while ((source = listNext(source)))
+    struct listMeta* meta = listMetaOf(source);
+    List copy = meta && !meta->placed
+        ? listInitWithAllocator(&meta->allocator)
+        : listInit();           /* the storage of a placed list is its own */
+    List element = source;
+    List last = copy;
+    STAT_DECLARE
+    if (copy == NULL)
+        return NULL;
+    STAT_START();
+    while ((element = listNext(element)))
     {
-        listPushBack(copy, source->v);
+        last = listAddAfter(copy, last, element->v);
+        if (last == NULL)
+        {
+            listFree(copy);
+            copy = NULL;
+            break;
+        }
+        STAT_NODE();
     }
+    STAT_STOP(source, LIST_OP_COPY);
     return copy;
 }
 
@@ -264,14 +865,19 @@ void listSort(List root, int (*cmp)(const void*, const void*))
 {
     List p, q, e, tail;
     List list = listBegin(root);
-    int insize, nmerges, psize, qsize, i;
+    size_t insize, nmerges, psize, qsize, i;
+    STAT_DECLARE
+    STAT_START();
 
     /*
      * Silly special case: if `list' was passed in as NULL, return
      * NULL immediately.
      */
     if (!list)
+    {
+        STAT_STOP(root, LIST_OP_SORT);
         return;
+    }
 
     insize = 1;
 
@@ -305,7 +911,7 @@ void listSort(List root, int (*cmp)(const void*, const void*))
                 } else if (qsize == 0 || !q) {
                     /* q is empty; e must come from p. */
                     e = p; p = listNext(p); --psize;
-                } else if (cmp(p->v,q->v) <= 0) {
+                } else if (STAT_COUNT(root, compares, 1), cmp(p->v,q->v) <= 0) {
                     /* First element of p is lower (or same);
                      * e must come from p. */
                     e = p; p = listNext(p); --psize;
@@ -322,6 +928,7 @@ void listSort(List root, int (*cmp)(const void*, const void*))
                 }
                 e->p = tail;
                 tail = e;
+                STAT_NODE();
             }
 
             /* now p has stepped `insize' places along, and q has too */
@@ -336,6 +943,7 @@ void listSort(List root, int (*cmp)(const void*, const void*))
             for (iterator = root->n; iterator->n != NULL; iterator = listNext(iterator))
                 ;
             root->p = iterator;
+            STAT_STOP(root, LIST_OP_SORT);
             return;
         }
 
@@ -343,3 +951,62 @@ void listSort(List root, int (*cmp)(const void*, const void*))
         insize *= 2;
     }
 }
+
+
+int listStats(List root, ListStats* out)
+{
+#ifdef LIST_STATS
+    ListStats* stats = listStatsOf(root);
+    if (stats)
+    {
+        *out = *stats;
+        return 1;
+    }
+#else
+    (void) root;
+#endif
+    memset(out, 0, sizeof(ListStats));
+    return 0;
+}
+
+void listStatsGlobal(ListStats* out)
+{
+#ifdef LIST_STATS
+    /* ListStats is nothing but unsigned longs, load them one by one */
+    const unsigned long* from = (const unsigned long*) &globalStats;
+    unsigned long*       to   = (unsigned long*) out;
+    size_t               i;
+    for (i = 0; i < sizeof(ListStats) / sizeof(unsigned long); ++i)
+        to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+#else
+    memset(out, 0, sizeof(ListStats));
+#endif
+}
+
+void listStatsDump(FILE* stream)
+{
+#ifdef LIST_STATS
+    static const char* names[LIST_OPS] =
+        { "get", "getVal", "pushSort", "add", "remove", "sort", "copy" };
+    ListStats stats;
+    int op, bucket;
+
+    listStatsGlobal(&stats);
+    fprintf(stream, "nodes allocated: %lu\n", stats.allocs);
+    fprintf(stream, "nodes freed:     %lu\n", stats.frees);
+    fprintf(stream, "compare calls:   %lu\n", stats.compares);
+    for (op = 0; op < LIST_OPS; ++op)
+    {
+        if (stats.calls[op] == 0)
+            continue;
+        fprintf(stream, "%s: %lu calls, %lu nodes traversed\n", names[op],
+                stats.calls[op], stats.traversed[op]);
+        for (bucket = 0; bucket < LIST_STAT_BUCKETS; ++bucket)
+            if (stats.latency[op][bucket])
+                fprintf(stream, "    >= %10lu ns: %lu\n", 1UL << bucket,
+                        stats.latency[op][bucket]);
+    }
+#else
+    fprintf(stream, "list statistics are disabled, build with LIST_STATS\n");
+#endif
+}
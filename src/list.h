@@ -19,6 +19,9 @@
 #ifndef _LIST_H_
 #define _LIST_H_
 
+#include <stddef.h>
+#include <stdio.h>
+
  #ifdef __cplusplus
  extern "C"
  {
@@ -33,6 +36,52 @@ typedef struct list
     struct list* p;             /* pointer to the previous element */
 } *List;
 
+typedef struct listAllocator
+{
+    void* (*alloc)(size_t size, void* ctx);
+    void  (*free) (void* ptr,   void* ctx);
+    void*   ctx;                /* passed to both of the above */
+} ListAllocator;
+
+/* number of the nodes of the buffer of a list holding up to N elements */
+#define LIST_FIXED_OVERHEAD 3
+#define LIST_FIXED_SLOTS(N) ((N) + LIST_FIXED_OVERHEAD)
+
+/* flags of listArenaCreate */
+enum
+{
+    LIST_ARENA_THP     = 1,     /* ask for transparent huge pages */
+    LIST_ARENA_HUGETLB = 2      /* use explicit huge pages if there are any */
+};
+
+typedef struct listArena* ListArena;
+
+/* operations timed when built with LIST_STATS */
+enum
+{
+    LIST_OP_GET,
+    LIST_OP_GETVAL,
+    LIST_OP_PUSHSORT,
+    LIST_OP_ADD,
+    LIST_OP_REMOVE,
+    LIST_OP_SORT,
+    LIST_OP_COPY,
+    LIST_OPS
+};
+
+#define LIST_STAT_BUCKETS 32
+
+typedef struct listStats
+{
+    unsigned long allocs;       /* nodes allocated */
+    unsigned long frees;        /* nodes freed */
+    unsigned long compares;     /* comparison function calls */
+    unsigned long calls    [LIST_OPS];
+    unsigned long traversed[LIST_OPS];
+    /* bucket i counts the calls that took between 2^i and 2^(i+1) ns */
+    unsigned long latency  [LIST_OPS][LIST_STAT_BUCKETS];
+} ListStats;
+
 #define listNext(A)   A->n
 #define listPrev(A)   A->p
 #define listBegin(A)  A->n
@@ -42,18 +91,41 @@ typedef struct list
 #define newListNode() ((List) malloc(sizeof(struct list)))
 
 List  listInit      (void);
-void  listPushBack  (List root,  void* val);
-void  listPushFront (List root,  void* val);
-void  listPushSort  (List root,  void* val, int (*compare)(const void*, const void*));
+List  listInitWithAllocator (const ListAllocator* allocator);
+List  listInitFixed (void* buffer, size_t size);
+int   listPushBack  (List root,  void* val);
+int   listPushFront (List root,  void* val);
+int   listPushSort  (List root,  void* val, int (*compare)(const void*, const void*));
 List  listAddAfter  (List root,  List place, void* val);
 void  listFree      (List root);
 void  listFreeDeep  (List root);
 List  listGet       (List root,  int n);
+List  listGetAt     (List root,  size_t n);
 List  listGetVal    (List root,  void* val, int (*compare)(const void*, const void*));
 void  listRemove    (List root,  List element);
 int   listRemoveN   (List root,  int n);
+int   listRemoveAt  (List root,  size_t n);
 int   listRemoveVal (List root,  void* val, int (*compare)(const void*, const void*));
+void  listMoveAfter (List root,  List place, List element);
+void  listMoveToFront (List root, List element);
+void  listMoveToBack  (List root, List element);
+void  listSplice      (List root, List src);
+size_t listSpliceN    (List root, List src, size_t n);
+void  listLinkNode    (List root, List place, List element);
+void  listUnlinkNode  (List root, List element);
+int   listRemoveIf  (List root,  int (*pred)(const void*, void*), void* arg, void (*destroy)(void*));
+int   listFilter    (List root,  List dest, int (*pred)(const void*, void*), void* arg);
+int   listPartition (List root,  int (*pred)(const void*, void*), void* arg);
+size_t listUnion      (List root, List other, int (*compare)(const void*, const void*),
+                       void (*destroy)(void*));
+size_t listIntersect  (List root, List other, int (*compare)(const void*, const void*),
+                       void (*destroy)(void*));
+size_t listDifference (List root, List other, int (*compare)(const void*, const void*),
+                       void (*destroy)(void*));
+size_t listUnique     (List root, int (*compare)(const void*, const void*),
+                       void (*destroy)(void*));
 int   listLength    (List root);
+size_t listSize     (List root);
 int   listIsEmpty   (List root);
 void  listEmpty     (List root);
 void* listPopBack   (List root);
@@ -62,6 +134,14 @@ List  listCopy      (List source);
 void  listForeach   (List root, void (*fun)(void*, void*), void* arg);
 int   listSwap      (List root, List place);
 void  listSort      (List root, int (*cmp)(const void*, const void*));
+/* no-ops reporting zeros unless built with LIST_STATS */
+int   listStats     (List root, ListStats* out);
+void  listStatsGlobal (ListStats* out);
+void  listStatsDump (FILE* stream);
+
+ListArena listArenaCreate    (size_t region, int flags);
+void      listArenaAllocator (ListArena arena, ListAllocator* out);
+void      listArenaDestroy   (ListArena arena);
 
 
  #ifdef __cplusplus
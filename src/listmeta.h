@@ -0,0 +1,44 @@
+/* File: listmeta.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _LISTMETA_H_
+#define _LISTMETA_H_
+
+#include "list.h"
+
+/*
+ * Internal to the library, not installed: lets the other modules keep the
+ * root of a list and its private data in their own structures.
+ */
+
+/* Private data of a list, kept in the otherwise unused value of the root. */
+struct listMeta
+{
+    ListAllocator allocator;
+    ListStats*    stats;
+    int           placed;       /* the root and this are the caller's */
+};
+
+/* Makes root an empty list using allocator for its nodes. The root and meta
+ * are neither allocated nor freed with it, but listFree still passes both to
+ * allocator->free, which has to ignore them or release its storage then.
+ * stats may be NULL and is ignored unless built with LIST_STATS. */
+void listInitPlaced (List root, struct listMeta* meta,
+                     const ListAllocator* allocator, ListStats* stats);
+
+#endif
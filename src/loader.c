@@ -0,0 +1,227 @@
+/* File: loader.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "loader.h"
+#include "listmeta.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * The file is mapped read-only and the views point right into it. All the
+ * nodes, each followed by its view, are allocated as a single block, and the
+ * root lives in the loader itself, so the list can be freed without walking
+ * it unless some nodes were added later; these come from malloc. Freeing the
+ * root releases the whole loader, so listFree works as well as listUnload.
+ */
+struct loadedNode
+{
+    struct list node;
+    ListView    view;
+};
+
+struct listLoader
+{
+    struct list        root;    /* must be the first member */
+    struct listMeta    meta;
+    ListStats          stats;
+    void*              map;
+    size_t             size;
+    struct loadedNode* nodes;
+    size_t             count;
+    size_t             extra;   /* number of the nodes outside of the block */
+};
+
+static void* loaderAlloc(size_t size, void* ctx)
+{
+    struct listLoader* loader = (struct listLoader*) ctx;
+    void*              ptr    = malloc(size);
+    if (ptr)
+        ++loader->extra;
+    return ptr;
+}
+
+static void loaderFree(void* ptr, void* ctx)
+{
+    struct listLoader* loader = (struct listLoader*) ctx;
+    struct loadedNode* node   = (struct loadedNode*) ptr;
+
+    if (ptr == &loader->meta
+        || (node >= loader->nodes && node < loader->nodes + loader->count))
+        return;
+    if (ptr == &loader->root)
+    {
+        /* the root goes last, when the list is freed */
+        if (loader->map)
+            munmap(loader->map, loader->size);
+        free(loader->nodes);
+        free(loader);
+        return;
+    }
+    --loader->extra;
+    free(ptr);
+}
+
+/* maps the file and creates an empty list for it */
+static struct listLoader* loaderOpen(const char* path)
+{
+    struct listLoader* loader;
+    struct stat        st;
+    ListAllocator      allocator;
+    int                fd = open(path, O_RDONLY);
+
+    if (fd == -1)
+        return NULL;
+    loader = (struct listLoader*) calloc(1, sizeof(struct listLoader));
+    if (loader == NULL || fstat(fd, &st) == -1)
+    {
+        free(loader);
+        close(fd);
+        return NULL;
+    }
+
+    loader->size = st.st_size;
+    if (loader->size > 0)
+    {
+        loader->map = mmap(NULL, loader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (loader->map == MAP_FAILED)
+        {
+            free(loader);
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+
+    allocator.alloc = loaderAlloc;
+    allocator.free  = loaderFree;
+    allocator.ctx   = loader;
+    listInitPlaced(&loader->root, &loader->meta, &allocator, &loader->stats);
+    return loader;
+}
+
+/* allocates the nodes for count views and links them to the root */
+static int loaderLink(struct listLoader* loader, size_t count)
+{
+    size_t i;
+
+    if (count == 0)
+        return 1;
+    loader->nodes = (struct loadedNode*) malloc(count * sizeof(struct loadedNode));
+    if (loader->nodes == NULL)
+        return 0;
+    loader->count = count;
+
+    for (i = 0; i < count; ++i)
+    {
+        struct list* node = &loader->nodes[i].node;
+        node->isRoot = 0;
+        node->v      = &loader->nodes[i].view;
+        node->p      = i > 0         ? &loader->nodes[i - 1].node : NULL;
+        node->n      = i + 1 < count ? &loader->nodes[i + 1].node : NULL;
+    }
+    loader->root.n = &loader->nodes[0].node;
+    loader->root.p = &loader->nodes[count - 1].node;
+    return 1;
+}
+
+List listLoadLines(const char* path, int delim)
+{
+    struct listLoader* loader = loaderOpen(path);
+    const char*        data;
+    const char*        end;
+    const char*        next;
+    size_t             count = 0;
+    size_t             i;
+
+    if (loader == NULL)
+        return NULL;
+    data = (const char*) loader->map;
+    end  = data + loader->size;
+
+    /* count the lines first, the last one may lack the delimiter */
+    for (next = data; next < end; ++count)
+    {
+        next = (const char*) memchr(next, delim, end - next);
+        next = next ? next + 1 : end;
+    }
+    if (!loaderLink(loader, count))
+    {
+        listUnload(&loader->root);
+        return NULL;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        next = (const char*) memchr(data, delim, end - data);
+        if (next == NULL)
+            next = end;
+        loader->nodes[i].view.data = data;
+        loader->nodes[i].view.len  = next - data;
+        data = next + 1;
+    }
+    return &loader->root;
+}
+
+List listLoadRecords(const char* path, size_t size)
+{
+    struct listLoader* loader;
+    const char*        data;
+    size_t             count;
+    size_t             i;
+
+    if (size == 0)
+        return NULL;
+    loader = loaderOpen(path);
+    if (loader == NULL)
+        return NULL;
+    data  = (const char*) loader->map;
+    count = (loader->size + size - 1) / size;
+    if (!loaderLink(loader, count))
+    {
+        listUnload(&loader->root);
+        return NULL;
+    }
+
+    /* the last record may be shorter */
+    for (i = 0; i < count; ++i)
+    {
+        loader->nodes[i].view.data = data + i * size;
+        loader->nodes[i].view.len  = i + 1 < count ? size : loader->size - i * size;
+    }
+    return &loader->root;
+}
+
+void listUnload(List root)
+{
+    struct listLoader* loader = (struct listLoader*) root;
+    if (root == NULL)
+        return;
+    if (loader->extra == 0)
+    {
+        /* all the nodes are in the block */
+        root->n = NULL;
+        root->p = NULL;
+    }
+    listFree(root);
+}
@@ -0,0 +1,48 @@
+/* File: loader.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _LOADER_H_
+#define _LOADER_H_
+
+#include <stddef.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+/* a piece of the mapped file, not terminated with a null character */
+typedef struct listView
+{
+    const char* data;
+    size_t      len;
+} ListView;
+
+#define listViewOf(A) ((ListView*) (A)->v)
+
+List listLoadLines   (const char* path, int delim);
+List listLoadRecords (const char* path, size_t size);
+void listUnload      (List root);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,206 @@
+/* File: lru.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "lru.h"
+#include "list.h"
+#include <stdlib.h>
+
+/*
+ * The entries are kept in a list from the most to the least recently used
+ * one and in a chained hash table. A hit only relinks the entry's node to the
+ * front of the list; once the cache is full, the least recently used entry
+ * and its node are reused for the new one.
+ */
+struct lruEntry
+{
+    void*            key;
+    void*            val;
+    unsigned long    hash;
+    struct lruEntry* chain;     /* next entry in the same bucket */
+    List             node;      /* the node pointing back to this entry */
+};
+
+struct lruCache
+{
+    List               order;
+    struct lruEntry**  buckets;
+    unsigned long      mask;    /* number of buckets - 1 */
+    size_t             length;
+    size_t             capacity;
+    unsigned long    (*hash)(const void*);
+    int              (*compare)(const void*, const void*);
+    void             (*evict)(void*, void*, void*);
+    void*              arg;
+    LruStats           stats;
+};
+
+LruCache lruInit(size_t capacity,
+                 unsigned long (*hash)(const void* key),
+                 int (*compare)(const void*, const void*),
+                 void (*evict)(void* key, void* val, void* arg), void* arg)
+{
+    LruCache      cache;
+    unsigned long nbuckets = 1;
+
+    if (capacity == 0)
+        return NULL;
+    while (nbuckets < capacity)
+        nbuckets <<= 1;
+
+    cache = (LruCache) malloc(sizeof(struct lruCache));
+    if (cache == NULL)
+        return NULL;
+    cache->buckets = (struct lruEntry**) calloc(nbuckets, sizeof(struct lruEntry*));
+    cache->order   = listInit();
+    if (cache->buckets == NULL || cache->order == NULL)
+    {
+        free(cache->buckets);
+        listFree(cache->order);
+        free(cache);
+        return NULL;
+    }
+    cache->mask            = nbuckets - 1;
+    cache->length          = 0;
+    cache->capacity        = capacity;
+    cache->hash            = hash;
+    cache->compare         = compare;
+    cache->evict           = evict;
+    cache->arg             = arg;
+    cache->stats.hits      = 0;
+    cache->stats.misses    = 0;
+    cache->stats.evictions = 0;
+    return cache;
+}
+
+void lruFree(LruCache cache)
+{
+    List it;
+    if (cache == NULL)
+        return;
+    for (it = listBegin(cache->order); it; it = listNext(it))
+    {
+        struct lruEntry* entry = (struct lruEntry*) it->v;
+        if (cache->evict)
+            cache->evict(entry->key, entry->val, cache->arg);
+        free(entry);
+    }
+    listFree(cache->order);
+    free(cache->buckets);
+    free(cache);
+}
+
+/* returns the pointer to the link pointing to the entry with the key */
+static struct lruEntry** lruFind(LruCache cache, const void* key, unsigned long hash)
+{
+    struct lruEntry** link = &cache->buckets[hash & cache->mask];
+    while (*link && ((*link)->hash != hash || cache->compare((*link)->key, key) != 0))
+        link = &(*link)->chain;
+    return link;
+}
+
+void* lruGet(LruCache cache, const void* key)
+{
+    struct lruEntry* entry = *lruFind(cache, key, cache->hash(key));
+    if (entry == NULL)
+    {
+        ++cache->stats.misses;
+        return NULL;
+    }
+    ++cache->stats.hits;
+    listMoveToFront(cache->order, entry->node);
+    return entry->val;
+}
+
+int lruPut(LruCache cache, void* key, void* val)
+{
+    unsigned long     hash = cache->hash(key);
+    struct lruEntry** link = lruFind(cache, key, hash);
+    struct lruEntry*  entry = *link;
+
+    if (entry)
+    {
+        /* replacing the value of an existing key, only what is dropped leaves */
+        if (cache->evict && (entry->key != key || entry->val != val))
+            cache->evict(entry->key != key ? entry->key : NULL,
+                         entry->val != val ? entry->val : NULL, cache->arg);
+        entry->key = key;
+        entry->val = val;
+        listMoveToFront(cache->order, entry->node);
+        return 1;
+    }
+
+    if (cache->length == cache->capacity)
+    {
+        /* reuse the least recently used entry */
+        struct lruEntry** victim;
+        entry  = (struct lruEntry*) listRBegin(cache->order)->v;
+        victim = lruFind(cache, entry->key, entry->hash);
+        *victim = entry->chain;
+        ++cache->stats.evictions;
+        if (cache->evict)
+            cache->evict(entry->key, entry->val, cache->arg);
+        listMoveToFront(cache->order, entry->node);
+        /* the victim may have been the one link points past */
+        link = lruFind(cache, key, hash);
+    }
+    else
+    {
+        entry = (struct lruEntry*) malloc(sizeof(struct lruEntry));
+        if (entry == NULL)
+            return 0;
+        entry->node = listAddAfter(cache->order, cache->order, entry);
+        if (entry->node == NULL)
+        {
+            free(entry);
+            return 0;
+        }
+        ++cache->length;
+    }
+
+    entry->key   = key;
+    entry->val   = val;
+    entry->hash  = hash;
+    entry->chain = NULL;
+    *link        = entry;
+    return 1;
+}
+
+int lruRemove(LruCache cache, const void* key)
+{
+    struct lruEntry** link  = lruFind(cache, key, cache->hash(key));
+    struct lruEntry*  entry = *link;
+    if (entry == NULL)
+        return 0;
+    *link = entry->chain;
+    listRemove(cache->order, entry->node);
+    if (cache->evict)
+        cache->evict(entry->key, entry->val, cache->arg);
+    free(entry);
+    --cache->length;
+    return 1;
+}
+
+size_t lruLength(LruCache cache)
+{
+    return cache->length;
+}
+
+void lruStats(LruCache cache, LruStats* out)
+{
+    *out = cache->stats;
+}
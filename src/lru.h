@@ -0,0 +1,55 @@
+/* File: lru.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _LRU_H_
+#define _LRU_H_
+
+#include <stddef.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct lruCache* LruCache;
+
+typedef struct lruStats
+{
+    unsigned long hits;
+    unsigned long misses;
+    unsigned long evictions;
+} LruStats;
+
+LruCache lruInit   (size_t capacity,
+                    unsigned long (*hash)(const void* key),
+                    int (*compare)(const void*, const void*),
+                    void (*evict)(void* key, void* val, void* arg), void* arg);
+void     lruFree   (LruCache cache);
+
+void*    lruGet    (LruCache cache, const void* key);
+int      lruPut    (LruCache cache, void* key, void* val);
+int      lruRemove (LruCache cache, const void* key);
+size_t   lruLength (LruCache cache);
+void     lruStats  (LruCache cache, LruStats* out);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,356 @@
+/* File: packlist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "packlist.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PACK_BLOCK 236
+
+/*
+ * The values are kept in blocks of 256 bytes. The header of a block holds its
+ * first and last value, so the searches can skip whole blocks, and the other
+ * values are stored as the differences from the previous one, seven bits per
+ * byte, the highest bit set in all the bytes but the last one. Densely packed
+ * IDs take a byte or two each.
+ */
+struct packBlock
+{
+    uint64_t       first;
+    uint64_t       last;
+    unsigned short count;       /* number of values, including the first one */
+    unsigned short size;        /* bytes used in data */
+    unsigned char  data[PACK_BLOCK];
+};
+
+struct packList
+{
+    struct packBlock** blocks;
+    size_t             nblocks;
+    size_t             capacity;
+    size_t             length;
+};
+
+static size_t packLen(uint64_t delta)
+{
+    size_t len = 1;
+    while (delta >>= 7)
+        ++len;
+    return len;
+}
+
+static size_t packPut(unsigned char* out, uint64_t delta)
+{
+    size_t len = 0;
+    while (delta >= 0x80)
+    {
+        out[len++] = (unsigned char) (delta | 0x80);
+        delta    >>= 7;
+    }
+    out[len++] = (unsigned char) delta;
+    return len;
+}
+
+static uint64_t packGet(const unsigned char* in, size_t* offset)
+{
+    uint64_t delta = 0;
+    int      shift = 0;
+    while (in[*offset] & 0x80)
+    {
+        delta |= (uint64_t) (in[(*offset)++] & 0x7f) << shift;
+        shift += 7;
+    }
+    return delta | (uint64_t) in[(*offset)++] << shift;
+}
+
+/* returns the number of bytes taken by the deltas of the values */
+static size_t packSize(const uint64_t* vals, size_t n)
+{
+    size_t size = 0;
+    size_t i;
+    for (i = 1; i < n; ++i)
+        size += packLen(vals[i] - vals[i - 1]);
+    return size;
+}
+
+/* assumes the values fit in the block */
+static void packEncode(struct packBlock* block, const uint64_t* vals, size_t n)
+{
+    size_t i;
+    block->first = vals[0];
+    block->last  = vals[n - 1];
+    block->count = (unsigned short) n;
+    block->size  = 0;
+    for (i = 1; i < n; ++i)
+        block->size += (unsigned short) packPut(block->data + block->size,
+                                                vals[i] - vals[i - 1]);
+}
+
+static size_t packDecode(const struct packBlock* block, uint64_t* vals)
+{
+    size_t offset = 0;
+    size_t i;
+    vals[0] = block->first;
+    for (i = 1; i < block->count; ++i)
+        vals[i] = vals[i - 1] + packGet(block->data, &offset);
+    return block->count;
+}
+
+static int packInsertBlock(PackList list, size_t i, struct packBlock* block)
+{
+    if (list->nblocks == list->capacity)
+    {
+        size_t capacity = list->capacity ? 2 * list->capacity : 4;
+        struct packBlock** blocks = (struct packBlock**)
+            realloc(list->blocks, capacity * sizeof(struct packBlock*));
+        if (blocks == NULL)
+            return 0;
+        list->blocks   = blocks;
+        list->capacity = capacity;
+    }
+    memmove(list->blocks + i + 1, list->blocks + i,
+            (list->nblocks - i) * sizeof(struct packBlock*));
+    list->blocks[i] = block;
+    ++list->nblocks;
+    return 1;
+}
+
+/* returns the number of the blocks starting with a value not greater than val */
+static size_t packFind(PackList list, size_t from, uint64_t val)
+{
+    size_t lo = from;
+    size_t hi = list->nblocks;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (list->blocks[mid]->first <= val)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+PackList packListInit(void)
+{
+    PackList list = (PackList) malloc(sizeof(struct packList));
+    if (list == NULL)
+        return NULL;
+    list->blocks   = NULL;
+    list->nblocks  = 0;
+    list->capacity = 0;
+    list->length   = 0;
+    return list;
+}
+
+void packListFree(PackList list)
+{
+    size_t i;
+    if (list == NULL)
+        return;
+    for (i = 0; i < list->nblocks; ++i)
+        free(list->blocks[i]);
+    free(list->blocks);
+    free(list);
+}
+
+/* the value must be greater than all the values in the list */
+int packListAppend(PackList list, uint64_t val)
+{
+    struct packBlock* block = list->nblocks ? list->blocks[list->nblocks - 1] : NULL;
+
+    if (block && val <= block->last)
+        return 0;
+    if (block && block->size + packLen(val - block->last) <= PACK_BLOCK)
+    {
+        block->size += (unsigned short) packPut(block->data + block->size,
+                                                val - block->last);
+        block->last  = val;
+        ++block->count;
+        ++list->length;
+        return 1;
+    }
+
+    block = (struct packBlock*) malloc(sizeof(struct packBlock));
+    if (block == NULL)
+        return 0;
+    packEncode(block, &val, 1);
+    if (!packInsertBlock(list, list->nblocks, block))
+    {
+        free(block);
+        return 0;
+    }
+    ++list->length;
+    return 1;
+}
+
+/* returns 0 if the value is already in the list */
+int packListInsert(PackList list, uint64_t val)
+{
+    uint64_t          vals[PACK_BLOCK + 2];
+    struct packBlock* block;
+    struct packBlock* fresh;
+    size_t            i, n, pos;
+
+    if (list->nblocks == 0 || val > list->blocks[list->nblocks - 1]->last)
+        return packListAppend(list, val);
+
+    i = packFind(list, 0, val);
+    if (i > 0)
+        --i;
+    block = list->blocks[i];
+    n     = packDecode(block, vals);
+    for (pos = 0; pos < n && vals[pos] < val; ++pos)
+        ;
+    if (pos < n && vals[pos] == val)
+        return 0;
+    memmove(vals + pos + 1, vals + pos, (n - pos) * sizeof(uint64_t));
+    vals[pos] = val;
+    ++n;
+
+    if (packSize(vals, n) > PACK_BLOCK)
+    {
+        /* split the block in halves */
+        fresh = (struct packBlock*) malloc(sizeof(struct packBlock));
+        if (fresh == NULL)
+            return 0;
+        if (!packInsertBlock(list, i + 1, fresh))
+        {
+            free(fresh);
+            return 0;
+        }
+        packEncode(fresh, vals + n / 2, n - n / 2);
+        n /= 2;
+    }
+    packEncode(block, vals, n);
+    ++list->length;
+    return 1;
+}
+
+int packListContains(PackList list, uint64_t val)
+{
+    struct packBlock* block;
+    uint64_t          cur;
+    size_t            offset = 0;
+    size_t            i      = packFind(list, 0, val);
+
+    if (i == 0)
+        return 0;
+    block = list->blocks[i - 1];
+    if (val > block->last)
+        return 0;
+    for (cur = block->first, i = 1; cur < val && i < block->count; ++i)
+        cur += packGet(block->data, &offset);
+    return cur == val;
+}
+
+size_t packListLength(PackList list)
+{
+    return list->length;
+}
+
+size_t packListBytes(PackList list)
+{
+    return sizeof(struct packList)
+        + list->capacity * sizeof(struct packBlock*)
+        + list->nblocks * sizeof(struct packBlock);
+}
+
+void packListBegin(PackList list, PackCursor* cursor)
+{
+    cursor->list   = list;
+    cursor->block  = 0;
+    cursor->index  = 0;
+    cursor->offset = 0;
+    cursor->last   = 0;
+}
+
+int packListNext(PackCursor* cursor, uint64_t* val)
+{
+    struct packBlock* block;
+    if (cursor->block >= cursor->list->nblocks)
+        return 0;
+    block = cursor->list->blocks[cursor->block];
+    if (cursor->index == 0)
+    {
+        cursor->last   = block->first;
+        cursor->offset = 0;
+    }
+    else
+        cursor->last  += packGet(block->data, &cursor->offset);
+    if (++cursor->index == block->count)
+    {
+        ++cursor->block;
+        cursor->index = 0;
+    }
+    *val = cursor->last;
+    return 1;
+}
+
+/* moves the cursor past the first value not less than val and returns it */
+int packListSeek(PackCursor* cursor, uint64_t val, uint64_t* found)
+{
+    PackList list = cursor->list;
+    size_t   i;
+
+    /* skip the blocks ending before val without decoding them */
+    if (cursor->block < list->nblocks && list->blocks[cursor->block]->last < val)
+    {
+        i = packFind(list, cursor->block, val);
+        cursor->block = i - 1;
+        if (list->blocks[cursor->block]->last < val)
+            ++cursor->block;
+        cursor->index = 0;
+    }
+    while (packListNext(cursor, found))
+        if (*found >= val)
+            return 1;
+    return 0;
+}
+
+/* returns a new list of the values present in both lists */
+PackList packListIntersect(PackList a, PackList b)
+{
+    PackList   result = packListInit();
+    PackCursor ca, cb;
+    uint64_t   x, y;
+    int        more;
+
+    if (result == NULL)
+        return NULL;
+    packListBegin(a, &ca);
+    packListBegin(b, &cb);
+    more = packListNext(&ca, &x) && packListNext(&cb, &y);
+    while (more)
+    {
+        if (x < y)
+            more = packListSeek(&ca, y, &x);
+        else if (y < x)
+            more = packListSeek(&cb, x, &y);
+        else
+        {
+            if (!packListAppend(result, x))
+            {
+                packListFree(result);
+                return NULL;
+            }
+            more = packListNext(&ca, &x) && packListNext(&cb, &y);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,61 @@
+/* File: packlist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _PACKLIST_H_
+#define _PACKLIST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct packList* PackList;
+
+typedef struct packCursor
+{
+    PackList list;
+    size_t   block;
+    size_t   index;             /* of the next value in the block */
+    size_t   offset;            /* of its delta in the block */
+    uint64_t last;              /* the value returned last */
+} PackCursor;
+
+PackList packListInit      (void);
+void     packListFree      (PackList list);
+
+int      packListAppend    (PackList list, uint64_t val);
+int      packListInsert    (PackList list, uint64_t val);
+int      packListContains  (PackList list, uint64_t val);
+size_t   packListLength    (PackList list);
+size_t   packListBytes     (PackList list);
+
+void     packListBegin     (PackList list, PackCursor* cursor);
+int      packListNext      (PackCursor* cursor, uint64_t* val);
+int      packListSeek      (PackCursor* cursor, uint64_t val, uint64_t* found);
+
+PackList packListIntersect (PackList a, PackList b);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
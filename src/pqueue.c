@@ -0,0 +1,226 @@
+/* File: pqueue.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "pqueue.h"
+#include <stdlib.h>
+
+/*
+ * A pairing heap: pushing and decreasing a key are constant time melds with
+ * the root, popping pairs up the children of the root in two passes, which
+ * takes O(log n) amortized time.
+ */
+struct pqueue
+{
+    PQueueNode root;
+    size_t     length;
+    int      (*compare)(const void*, const void*);
+};
+
+/* both arguments must be detached roots */
+static PQueueNode pqueueMeld(PQueue queue, PQueueNode a, PQueueNode b)
+{
+    if (queue->compare(b->v, a->v) < 0)
+    {
+        PQueueNode tmp = a;
+        a = b;
+        b = tmp;
+    }
+    b->prev = a;
+    b->next = a->child;
+    if (a->child)
+        a->child->prev = b;
+    a->child = b;
+    return a;
+}
+
+/* turns a chain of siblings into a single heap */
+static PQueueNode pqueueCombine(PQueue queue, PQueueNode first)
+{
+    PQueueNode pairs = NULL;
+    PQueueNode result = NULL;
+    PQueueNode a, b, next;
+
+    /* meld the pairs from left to right, stacking them up... */
+    while (first)
+    {
+        a    = first;
+        b    = a->next;
+        next = b ? b->next : NULL;
+        a->next = a->prev = NULL;
+        if (b)
+        {
+            b->next = b->prev = NULL;
+            a = pqueueMeld(queue, a, b);
+        }
+        a->next = pairs;
+        pairs   = a;
+        first   = next;
+    }
+
+    /* ...and meld them together from right to left */
+    while (pairs)
+    {
+        next        = pairs->next;
+        pairs->next = NULL;
+        result      = result ? pqueueMeld(queue, result, pairs) : pairs;
+        pairs       = next;
+    }
+    return result;
+}
+
+/* cuts the subtree rooted at node off its parent */
+static void pqueueDetach(PQueueNode node)
+{
+    if (node->prev->child == node)
+        node->prev->child = node->next;
+    else
+        node->prev->next  = node->next;
+    if (node->next)
+        node->next->prev  = node->prev;
+    node->next = node->prev = NULL;
+}
+
+PQueue pqueueInit(int (*compare)(const void*, const void*))
+{
+    PQueue queue = (PQueue) malloc(sizeof(struct pqueue));
+    if (queue == NULL)
+        return NULL;
+    queue->root    = NULL;
+    queue->length  = 0;
+    queue->compare = compare;
+    return queue;
+}
+
+PQueue pqueueFromList(List source, int (*compare)(const void*, const void*))
+{
+    PQueue queue = pqueueInit(compare);
+    if (queue == NULL)
+        return NULL;
+    while ((source = listNext(source)))
+        if (pqueuePush(queue, source->v) == NULL)
+        {
+            pqueueFree(queue);
+            return NULL;
+        }
+    return queue;
+}
+
+static void pqueueFreeNodes(PQueue queue, int deep)
+{
+    PQueueNode stack = queue->root;
+    while (stack)
+    {
+        PQueueNode node  = stack;
+        PQueueNode child = node->child;
+        stack = node->next;
+        while (child)
+        {
+            PQueueNode next = child->next;
+            child->next = stack;
+            stack       = child;
+            child       = next;
+        }
+        if (deep)
+            free(node->v);
+        free(node);
+    }
+}
+
+void pqueueFree(PQueue queue)
+{
+    if (queue == NULL)
+        return;
+    pqueueFreeNodes(queue, 0);
+    free(queue);
+}
+
+void pqueueFreeDeep(PQueue queue)
+{
+    if (queue == NULL)
+        return;
+    pqueueFreeNodes(queue, 1);
+    free(queue);
+}
+
+PQueueNode pqueuePush(PQueue queue, void* val)
+{
+    PQueueNode node = (PQueueNode) malloc(sizeof(struct pqueueNode));
+    if (node == NULL)
+        return NULL;
+    node->v     = val;
+    node->child = NULL;
+    node->next  = NULL;
+    node->prev  = NULL;
+    queue->root = queue->root ? pqueueMeld(queue, queue->root, node) : node;
+    ++queue->length;
+    return node;
+}
+
+void* pqueuePop(PQueue queue)
+{
+    PQueueNode root = queue->root;
+    void*      val;
+    if (root == NULL)
+        return NULL;
+    val = root->v;
+    queue->root = pqueueCombine(queue, root->child);
+    --queue->length;
+    free(root);
+    return val;
+}
+
+void* pqueuePeek(PQueue queue)
+{
+    return queue->root ? queue->root->v : NULL;
+}
+
+/* the new value must not compare greater than the old one */
+void pqueueDecreaseKey(PQueue queue, PQueueNode node, void* val)
+{
+    node->v = val;
+    if (node == queue->root)
+        return;
+    pqueueDetach(node);
+    queue->root = pqueueMeld(queue, queue->root, node);
+}
+
+void pqueueRemove(PQueue queue, PQueueNode node)
+{
+    PQueueNode children;
+    if (node == queue->root)
+    {
+        pqueuePop(queue);
+        return;
+    }
+    pqueueDetach(node);
+    children = pqueueCombine(queue, node->child);
+    if (children)
+        queue->root = pqueueMeld(queue, queue->root, children);
+    --queue->length;
+    free(node);
+}
+
+size_t pqueueLength(PQueue queue)
+{
+    return queue->length;
+}
+
+int pqueueIsEmpty(PQueue queue)
+{
+    return queue->root == NULL;
+}
@@ -0,0 +1,58 @@
+/* File: pqueue.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _PQUEUE_H_
+#define _PQUEUE_H_
+
+#include <stddef.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct pqueueNode
+{
+    void*              v;       /* data pointer */
+    struct pqueueNode* child;   /* first child */
+    struct pqueueNode* next;    /* next sibling */
+    struct pqueueNode* prev;    /* previous sibling, the parent for the first child */
+} *PQueueNode;
+
+typedef struct pqueue* PQueue;
+
+PQueue     pqueueInit         (int (*compare)(const void*, const void*));
+PQueue     pqueueFromList     (List source, int (*compare)(const void*, const void*));
+void       pqueueFree         (PQueue queue);
+void       pqueueFreeDeep     (PQueue queue);
+
+PQueueNode pqueuePush         (PQueue queue, void* val);
+void*      pqueuePop          (PQueue queue);
+void*      pqueuePeek         (PQueue queue);
+void       pqueueDecreaseKey  (PQueue queue, PQueueNode node, void* val);
+void       pqueueRemove       (PQueue queue, PQueueNode node);
+size_t     pqueueLength       (PQueue queue);
+int        pqueueIsEmpty      (PQueue queue);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,326 @@
+/* File: ranklist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "ranklist.h"
+#include <stdlib.h>
+
+/*
+ * An implicit treap: a binary tree ordered by position, kept balanced by
+ * random heap priorities. Every node knows the size of its subtree, so the
+ * position of a node can be found by walking up to the root and the nth
+ * node by walking down from it, both in O(log n) expected time.
+ */
+struct rankList
+{
+    RankNode      root;
+    unsigned long seed;
+};
+
+#define rankSize(A) ((A) ? (A)->size : 0)
+
+static unsigned long rankRandom(RankList list)
+{
+    /* xorshift32, good enough for balancing */
+    unsigned long x = list->seed;
+    x ^= (x << 13) & 0xffffffffUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xffffffffUL;
+    return list->seed = x;
+}
+
+/* rotates x above its parent */
+static void rankRotateUp(RankList list, RankNode x)
+{
+    RankNode p = x->up;
+    RankNode g = p->up;
+
+    if (p->l == x)
+    {
+        p->l = x->r;
+        if (x->r)
+            x->r->up = p;
+        x->r = p;
+    }
+    else
+    {
+        p->r = x->l;
+        if (x->l)
+            x->l->up = p;
+        x->l = p;
+    }
+    p->up = x;
+    x->up = g;
+    if (g == NULL)
+        list->root = x;
+    else if (g->l == p)
+        g->l = x;
+    else
+        g->r = x;
+
+    x->size = p->size;
+    p->size = rankSize(p->l) + rankSize(p->r) + 1;
+}
+
+RankList rankListInit(void)
+{
+    RankList list = (RankList) malloc(sizeof(struct rankList));
+    if (list == NULL)
+        return NULL;
+    list->root = NULL;
+    list->seed = 2463534242UL;
+    return list;
+}
+
+RankList rankListFromList(List source)
+{
+    RankList list = rankListInit();
+    if (list == NULL)
+        return NULL;
+    while ((source = listNext(source)))
+        if (rankListPushBack(list, source->v) == NULL)
+        {
+            rankListFree(list);
+            return NULL;
+        }
+    return list;
+}
+
+static void rankListFreeNodes(RankList list, int deep)
+{
+    RankNode node = list->root;
+    while (node)
+    {
+        /* free the leaves bottom-up, without recursion */
+        if (node->l)
+            node = node->l;
+        else if (node->r)
+            node = node->r;
+        else
+        {
+            RankNode up = node->up;
+            if (up)
+            {
+                if (up->l == node)
+                    up->l = NULL;
+                else
+                    up->r = NULL;
+            }
+            if (deep)
+                free(node->v);
+            free(node);
+            node = up;
+        }
+    }
+    list->root = NULL;
+}
+
+void rankListFree(RankList list)
+{
+    if (list == NULL)
+        return;
+    rankListFreeNodes(list, 0);
+    free(list);
+}
+
+void rankListFreeDeep(RankList list)
+{
+    if (list == NULL)
+        return;
+    rankListFreeNodes(list, 1);
+    free(list);
+}
+
+RankNode rankListInsert(RankList list, size_t n, void* val)
+{
+    RankNode node;
+    RankNode it;
+
+    if (n > rankSize(list->root))
+        return NULL;            /* out-of-list exception */
+    node = (RankNode) malloc(sizeof(struct rankNode));
+    if (node == NULL)
+        return NULL;
+    node->v    = val;
+    node->l    = NULL;
+    node->r    = NULL;
+    node->up   = NULL;
+    node->size = 1;
+    node->prio = rankRandom(list);
+
+    /* insert as a leaf at the right position... */
+    it = list->root;
+    if (it == NULL)
+        list->root = node;
+    while (it)
+    {
+        ++it->size;
+        if (n <= rankSize(it->l))
+        {
+            if (it->l == NULL)
+            {
+                it->l = node;
+                break;
+            }
+            it = it->l;
+        }
+        else
+        {
+            n -= rankSize(it->l) + 1;
+            if (it->r == NULL)
+            {
+                it->r = node;
+                break;
+            }
+            it = it->r;
+        }
+    }
+    node->up = it;
+
+    /* ...and restore the heap order */
+    while (node->up && node->up->prio > node->prio)
+        rankRotateUp(list, node);
+    return node;
+}
+
+RankNode rankListPushBack(RankList list, void* val)
+{
+    return rankListInsert(list, rankSize(list->root), val);
+}
+
+RankNode rankListPushFront(RankList list, void* val)
+{
+    return rankListInsert(list, 0, val);
+}
+
+RankNode rankListGet(RankList list, size_t n)
+{
+    RankNode it = list->root;
+    while (it)
+    {
+        if (n < rankSize(it->l))
+            it = it->l;
+        else if (n == rankSize(it->l))
+            return it;
+        else
+        {
+            n -= rankSize(it->l) + 1;
+            it = it->r;
+        }
+    }
+    return NULL;                /* out-of-list exception */
+}
+
+void rankListRemove(RankList list, RankNode element)
+{
+    RankNode it;
+
+    /* rotate the node down until it becomes a leaf... */
+    while (element->l || element->r)
+    {
+        if (element->r == NULL
+            || (element->l && element->l->prio < element->r->prio))
+            rankRotateUp(list, element->l);
+        else
+            rankRotateUp(list, element->r);
+    }
+
+    /* ...and cut it off */
+    if (element->up == NULL)
+        list->root = NULL;
+    else if (element->up->l == element)
+        element->up->l = NULL;
+    else
+        element->up->r = NULL;
+    for (it = element->up; it; it = it->up)
+        --it->size;
+    free(element);
+}
+
+int rankListRemoveN(RankList list, size_t n)
+{
+    RankNode element = rankListGet(list, n);
+    if (element == NULL)
+        return 0;               /* out-of-list exception */
+    rankListRemove(list, element);
+    return 1;
+}
+
+size_t rankListRank(RankNode element)
+{
+    size_t rank = rankSize(element->l);
+    for (; element->up; element = element->up)
+        if (element->up->r == element)
+            rank += rankSize(element->up->l) + 1;
+    return rank;
+}
+
+size_t rankListLength(RankList list)
+{
+    return rankSize(list->root);
+}
+
+RankNode rankListBegin(RankList list)
+{
+    RankNode it = list->root;
+    while (it && it->l)
+        it = it->l;
+    return it;
+}
+
+RankNode rankListRBegin(RankList list)
+{
+    RankNode it = list->root;
+    while (it && it->r)
+        it = it->r;
+    return it;
+}
+
+RankNode rankListNext(RankNode iterator)
+{
+    if (iterator->r)
+    {
+        iterator = iterator->r;
+        while (iterator->l)
+            iterator = iterator->l;
+        return iterator;
+    }
+    while (iterator->up && iterator->up->r == iterator)
+        iterator = iterator->up;
+    return iterator->up;
+}
+
+RankNode rankListPrev(RankNode iterator)
+{
+    if (iterator->l)
+    {
+        iterator = iterator->l;
+        while (iterator->r)
+            iterator = iterator->r;
+        return iterator;
+    }
+    while (iterator->up && iterator->up->l == iterator)
+        iterator = iterator->up;
+    return iterator->up;
+}
+
+void rankListForeach(RankList list, void (*fun)(void*, void*), void* arg)
+{
+    RankNode it;
+    for (it = rankListBegin(list); it; it = rankListNext(it))
+        fun(it->v, arg);
+}
@@ -0,0 +1,70 @@
+/* File: ranklist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _RANKLIST_H_
+#define _RANKLIST_H_
+
+#include <stddef.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct rankNode
+{
+    void*            v;         /* data pointer */
+    struct rankNode* l;         /* left subtree, the preceding elements */
+    struct rankNode* r;         /* right subtree, the following elements */
+    struct rankNode* up;        /* parent, NULL in the tree root */
+    size_t           size;      /* number of nodes in this subtree */
+    unsigned long    prio;      /* heap priority keeping the tree balanced */
+} *RankNode;
+
+typedef struct rankList* RankList;
+
+#define rankListVal(A, T) (*(T*) (A)->v)
+#define rankListRef(A, T) ( (T*) (A)->v)
+
+RankList rankListInit      (void);
+RankList rankListFromList  (List source);
+void     rankListFree      (RankList list);
+void     rankListFreeDeep  (RankList list);
+
+RankNode rankListInsert    (RankList list, size_t n, void* val);
+RankNode rankListPushBack  (RankList list, void* val);
+RankNode rankListPushFront (RankList list, void* val);
+RankNode rankListGet       (RankList list, size_t n);
+void     rankListRemove    (RankList list, RankNode element);
+int      rankListRemoveN   (RankList list, size_t n);
+size_t   rankListRank      (RankNode element);
+size_t   rankListLength    (RankList list);
+
+RankNode rankListBegin     (RankList list);
+RankNode rankListRBegin    (RankList list);
+RankNode rankListNext      (RankNode iterator);
+RankNode rankListPrev      (RankNode iterator);
+void     rankListForeach   (RankList list, void (*fun)(void*, void*), void* arg);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,287 @@
+/* File: rculist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "rculist.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+ * Readers never write to the shared list, they only announce the epoch in
+ * which they started reading in their own slot. The writers unlink the
+ * nodes with plain release stores and keep them on the retired chain until
+ * every reader that could still see them is gone: a node removed in epoch E
+ * is freed once no reader has announced an epoch lower than or equal to E.
+ */
+struct rcuReader
+{
+    unsigned long epoch;        /* 0 when outside of a read section */
+    int           used;
+    char          pad[64 - sizeof(unsigned long) - sizeof(int)];
+};
+
+struct rcuList
+{
+    RcuNode           head;
+    RcuNode           tail;     /* only used by the writers */
+    unsigned long     epoch;
+    pthread_mutex_t   write;
+    RcuNode           retired;
+    int               nreaders;
+    struct rcuReader* readers;
+};
+
+#define rcuLoad(A)     __atomic_load_n(&(A), __ATOMIC_ACQUIRE)
+#define rcuStore(A, B) __atomic_store_n(&(A), (B), __ATOMIC_RELEASE)
+
+RcuList rcuListInit(int readers)
+{
+    RcuList list = (RcuList) malloc(sizeof(struct rcuList));
+    if (list == NULL)
+        return NULL;
+    list->readers = (struct rcuReader*) calloc(readers, sizeof(struct rcuReader));
+    if (list->readers == NULL)
+    {
+        free(list);
+        return NULL;
+    }
+    list->head     = NULL;
+    list->tail     = NULL;
+    list->epoch    = 1;
+    list->retired  = NULL;
+    list->nreaders = readers;
+    pthread_mutex_init(&list->write, NULL);
+    return list;
+}
+
+static void rcuFreeNode(RcuNode node)
+{
+    if (node->destroy)
+        node->destroy(node->v);
+    free(node);
+}
+
+void rcuListFree(RcuList list)
+{
+    RcuNode node;
+    if (list == NULL)
+        return;
+    while ((node = list->head))
+    {
+        list->head = node->n;
+        free(node);
+    }
+    while ((node = list->retired))
+    {
+        list->retired = node->retired;
+        rcuFreeNode(node);
+    }
+    pthread_mutex_destroy(&list->write);
+    free(list->readers);
+    free(list);
+}
+
+RcuReader rcuListRegister(RcuList list)
+{
+    RcuReader reader = NULL;
+    int       i;
+    pthread_mutex_lock(&list->write);
+    for (i = 0; i < list->nreaders; ++i)
+        if (!list->readers[i].used)
+        {
+            reader         = &list->readers[i];
+            reader->used   = 1;
+            reader->epoch  = 0;
+            break;
+        }
+    pthread_mutex_unlock(&list->write);
+    return reader;
+}
+
+void rcuListUnregister(RcuList list, RcuReader reader)
+{
+    pthread_mutex_lock(&list->write);
+    reader->used = 0;
+    pthread_mutex_unlock(&list->write);
+}
+
+void rcuListReadLock(RcuList list, RcuReader reader)
+{
+    __atomic_store_n(&reader->epoch, rcuLoad(list->epoch), __ATOMIC_RELAXED);
+    /* the announcement must be visible before the list is read */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void rcuListReadUnlock(RcuList list, RcuReader reader)
+{
+    (void) list;
+    rcuStore(reader->epoch, 0);
+}
+
+RcuNode rcuListBegin(RcuList list)
+{
+    return rcuLoad(list->head);
+}
+
+RcuNode rcuListNext(RcuNode iterator)
+{
+    return rcuLoad(iterator->n);
+}
+
+/* compare should return -1 on lesser, 0 on equal and 1 on greater */
+void* rcuListGetVal(RcuList list, void* val, int (*compare)(const void*, const void*))
+{
+    RcuNode it;
+    for (it = rcuListBegin(list); it; it = rcuListNext(it))
+        if (compare(it->v, val) == 0)
+            return it->v;
+    return NULL;
+}
+
+void rcuListForeach(RcuList list, RcuReader reader, void (*fun)(void*, void*), void* arg)
+{
+    RcuNode it;
+    rcuListReadLock(list, reader);
+    for (it = rcuListBegin(list); it; it = rcuListNext(it))
+        fun(it->v, arg);
+    rcuListReadUnlock(list, reader);
+}
+
+static RcuNode rcuNewNode(void* val)
+{
+    RcuNode node = (RcuNode) malloc(sizeof(struct rcuNode));
+    if (node)
+    {
+        node->v       = val;
+        node->n       = NULL;
+        node->retired = NULL;
+        node->epoch   = 0;
+        node->destroy = NULL;
+    }
+    return node;
+}
+
+int rcuListPushBack(RcuList list, void* val)
+{
+    RcuNode node = rcuNewNode(val);
+    if (node == NULL)
+        return 0;
+    pthread_mutex_lock(&list->write);
+    /* the node is complete before it gets published */
+    if (list->tail)
+        rcuStore(list->tail->n, node);
+    else
+        rcuStore(list->head, node);
+    list->tail = node;
+    pthread_mutex_unlock(&list->write);
+    return 1;
+}
+
+int rcuListPushFront(RcuList list, void* val)
+{
+    RcuNode node = rcuNewNode(val);
+    if (node == NULL)
+        return 0;
+    pthread_mutex_lock(&list->write);
+    node->n = list->head;
+    rcuStore(list->head, node);
+    if (list->tail == NULL)
+        list->tail = node;
+    pthread_mutex_unlock(&list->write);
+    return 1;
+}
+
+/* assumes the write lock is held */
+static int rcuReclaimLocked(RcuList list)
+{
+    unsigned long oldest;
+    RcuNode*      it;
+    int           i;
+    int           pending = 0;
+
+    if (list->retired == NULL)
+        return 0;
+
+    /* new readers will not see anything retired so far */
+    oldest = list->epoch;
+    __atomic_store_n(&list->epoch, oldest + 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (i = 0; i < list->nreaders; ++i)
+    {
+        unsigned long epoch = __atomic_load_n(&list->readers[i].epoch, __ATOMIC_ACQUIRE);
+        if (epoch && epoch < oldest)
+            oldest = epoch;
+    }
+
+    it = &list->retired;
+    while (*it)
+    {
+        RcuNode node = *it;
+        if (node->epoch < oldest)
+        {
+            *it = node->retired;
+            rcuFreeNode(node);
+        }
+        else
+        {
+            it = &node->retired;
+            ++pending;
+        }
+    }
+    return pending;
+}
+
+int rcuListReclaim(RcuList list)
+{
+    int pending;
+    pthread_mutex_lock(&list->write);
+    pending = rcuReclaimLocked(list);
+    pthread_mutex_unlock(&list->write);
+    return pending;
+}
+
+/* compare should return -1 on lesser, 0 on equal and 1 on greater */
+int rcuListRemoveVal(RcuList list, void* val, int (*compare)(const void*, const void*),
+                     void (*destroy)(void*))
+{
+    RcuNode prev = NULL;
+    RcuNode node;
+
+    pthread_mutex_lock(&list->write);
+    for (node = list->head; node && compare(node->v, val) != 0; node = node->n)
+        prev = node;
+    if (node)
+    {
+        /* readers standing on the node may still follow its next pointer */
+        if (prev)
+            rcuStore(prev->n, node->n);
+        else
+            rcuStore(list->head, node->n);
+        if (list->tail == node)
+            list->tail = prev;
+
+        node->destroy = destroy;
+        node->epoch   = list->epoch;
+        node->retired = list->retired;
+        list->retired = node;
+        rcuReclaimLocked(list);
+    }
+    pthread_mutex_unlock(&list->write);
+    return node != NULL;
+}
@@ -0,0 +1,65 @@
+/* File: rculist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _RCULIST_H_
+#define _RCULIST_H_
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct rcuNode
+{
+    struct rcuNode* n;          /* pointer to the next element */
+    void*           v;          /* data pointer */
+    struct rcuNode* retired;    /* next node waiting to be freed */
+    unsigned long   epoch;      /* epoch in which the node was removed */
+    void          (*destroy)(void*);
+} *RcuNode;
+
+typedef struct rcuList*   RcuList;
+typedef struct rcuReader* RcuReader;
+
+#define rcuListVal(A, T) (*(T*) (A)->v)
+#define rcuListRef(A, T) ( (T*) (A)->v)
+
+RcuList   rcuListInit       (int readers);
+void      rcuListFree       (RcuList list);
+
+RcuReader rcuListRegister   (RcuList list);
+void      rcuListUnregister (RcuList list, RcuReader reader);
+void      rcuListReadLock   (RcuList list, RcuReader reader);
+void      rcuListReadUnlock (RcuList list, RcuReader reader);
+RcuNode   rcuListBegin      (RcuList list);
+RcuNode   rcuListNext       (RcuNode iterator);
+void*     rcuListGetVal     (RcuList list, void* val, int (*compare)(const void*, const void*));
+void      rcuListForeach    (RcuList list, RcuReader reader, void (*fun)(void*, void*), void* arg);
+
+int       rcuListPushBack   (RcuList list, void* val);
+int       rcuListPushFront  (RcuList list, void* val);
+int       rcuListRemoveVal  (RcuList list, void* val, int (*compare)(const void*, const void*),
+                             void (*destroy)(void*));
+int       rcuListReclaim    (RcuList list);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,351 @@
+/* File: shmlist.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "shmlist.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHMLIST_MAGIC 0x4c495354UL /* "LIST" */
+
+/* Lives at the very beginning of the segment, followed by the nodes. */
+struct shmListHeader
+{
+    unsigned long    magic;
+    size_t           capacity;
+    size_t           valsize;
+    size_t           nodesize;
+    size_t           length;
+    long             head;      /* self-relative, 0 if empty */
+    long             tail;      /* self-relative, 0 if empty */
+    long             free;      /* self-relative chain of unused nodes */
+    pthread_rwlock_t lock;
+};
+
+struct shmList
+{
+    struct shmListHeader* hdr;
+    size_t                size;
+};
+
+#define ALIGN(A) (((A) + 2 * sizeof(long) - 1) & ~(2 * sizeof(long) - 1))
+
+static void* relGet(long* field)
+{
+    return *field ? (char*) field + *field : NULL;
+}
+
+static void relSet(long* field, void* target)
+{
+    *field = target ? (char*) target - (char*) field : 0;
+}
+
+/* returns 0 if the segment would not fit in size_t */
+static int shmListSize(size_t capacity, size_t nodesize, size_t* size)
+{
+    size_t header = ALIGN(sizeof(struct shmListHeader));
+    if (nodesize && capacity > ((size_t) -1 - header) / nodesize)
+        return 0;
+    *size = header + capacity * nodesize;
+    return 1;
+}
+
+static ShmList shmListMap(int fd, size_t size)
+{
+    ShmList list = (ShmList) malloc(sizeof(struct shmList));
+    void*   addr;
+    if (list == NULL)
+        return NULL;
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        free(list);
+        return NULL;
+    }
+    list->hdr  = (struct shmListHeader*) addr;
+    list->size = size;
+    return list;
+}
+
+ShmList shmListCreate(const char* name, size_t capacity, size_t valsize)
+{
+    struct shmListHeader* hdr;
+    pthread_rwlockattr_t  attr;
+    ShmList list;
+    size_t  nodesize;
+    size_t  size;
+    size_t  i;
+    char*   nodes;
+    int     fd;
+
+    if (valsize > (size_t) -1 - sizeof(ShmListNode) - 2 * sizeof(long))
+        return NULL;
+    nodesize = sizeof(ShmListNode) + ALIGN(valsize);
+    if (!shmListSize(capacity, nodesize, &size))
+        return NULL;
+
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1)
+        return NULL;
+    if (ftruncate(fd, size) == -1 || (list = shmListMap(fd, size)) == NULL)
+    {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    close(fd);
+
+    hdr           = list->hdr;
+    hdr->capacity = capacity;
+    hdr->valsize  = valsize;
+    hdr->nodesize = nodesize;
+    hdr->length   = 0;
+    hdr->head     = 0;
+    hdr->tail     = 0;
+    hdr->free     = 0;
+
+    /* chain all the nodes as free, the first one ending up on top */
+    nodes = (char*) hdr + ALIGN(sizeof(struct shmListHeader));
+    for (i = capacity; i-- > 0;)
+    {
+        ShmListNode* node = (ShmListNode*) (nodes + i * nodesize);
+        relSet(&node->n, relGet(&hdr->free));
+        node->p = 0;
+        relSet(&hdr->free, node);
+    }
+
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_rwlock_init(&hdr->lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+
+    /* only now the segment is usable by the others */
+    __atomic_store_n(&hdr->magic, SHMLIST_MAGIC, __ATOMIC_RELEASE);
+    return list;
+}
+
+ShmList shmListOpen(const char* name)
+{
+    struct shmListHeader* hdr;
+    ShmList               list;
+    struct stat           st;
+    size_t                size;
+    int                   fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1)
+        return NULL;
+    if (fstat(fd, &st) == -1
+        || (size_t) st.st_size < sizeof(struct shmListHeader)
+        || (list = shmListMap(fd, st.st_size)) == NULL)
+    {
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    /* reject the segments not initialized yet, foreign or truncated ones */
+    hdr = list->hdr;
+    if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHMLIST_MAGIC
+        || hdr->valsize > (size_t) -1 - sizeof(ShmListNode) - 2 * sizeof(long)
+        || hdr->nodesize != sizeof(ShmListNode) + ALIGN(hdr->valsize)
+        || !shmListSize(hdr->capacity, hdr->nodesize, &size)
+        || size > list->size)
+    {
+        shmListClose(list);
+        return NULL;
+    }
+    return list;
+}
+
+void shmListClose(ShmList list)
+{
+    if (list == NULL)
+        return;
+    munmap(list->hdr, list->size);
+    free(list);
+}
+
+int shmListUnlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
+
+/* assumes the write lock is held */
+static ShmListNode* shmListNewNode(ShmList list, const void* val)
+{
+    struct shmListHeader* hdr  = list->hdr;
+    ShmListNode*          node = (ShmListNode*) relGet(&hdr->free);
+    if (node == NULL)
+        return NULL;            /* out of space in the segment */
+    relSet(&hdr->free, relGet(&node->n));
+    memcpy(node + 1, val, hdr->valsize);
+    ++hdr->length;
+    return node;
+}
+
+/* assumes the write lock is held */
+static void shmListUnlinkNode(ShmList list, ShmListNode* node, void* out)
+{
+    struct shmListHeader* hdr  = list->hdr;
+    ShmListNode*          next = (ShmListNode*) relGet(&node->n);
+    ShmListNode*          prev = (ShmListNode*) relGet(&node->p);
+
+    if (prev)
+        relSet(&prev->n, next);
+    else
+        relSet(&hdr->head, next);
+    if (next)
+        relSet(&next->p, prev);
+    else
+        relSet(&hdr->tail, prev);
+
+    if (out)
+        memcpy(out, node + 1, hdr->valsize);
+    relSet(&node->n, relGet(&hdr->free));
+    node->p = 0;
+    relSet(&hdr->free, node);
+    --hdr->length;
+}
+
+int shmListPushBack(ShmList list, const void* val)
+{
+    struct shmListHeader* hdr = list->hdr;
+    ShmListNode*          node;
+
+    pthread_rwlock_wrlock(&hdr->lock);
+    node = shmListNewNode(list, val);
+    if (node)
+    {
+        ShmListNode* tail = (ShmListNode*) relGet(&hdr->tail);
+        node->n = 0;
+        relSet(&node->p, tail);
+        if (tail)
+            relSet(&tail->n, node);
+        else
+            relSet(&hdr->head, node);
+        relSet(&hdr->tail, node);
+    }
+    pthread_rwlock_unlock(&hdr->lock);
+    return node != NULL;
+}
+
+int shmListPushFront(ShmList list, const void* val)
+{
+    struct shmListHeader* hdr = list->hdr;
+    ShmListNode*          node;
+
+    pthread_rwlock_wrlock(&hdr->lock);
+    node = shmListNewNode(list, val);
+    if (node)
+    {
+        ShmListNode* head = (ShmListNode*) relGet(&hdr->head);
+        relSet(&node->n, head);
+        node->p = 0;
+        if (head)
+            relSet(&head->p, node);
+        else
+            relSet(&hdr->tail, node);
+        relSet(&hdr->head, node);
+    }
+    pthread_rwlock_unlock(&hdr->lock);
+    return node != NULL;
+}
+
+int shmListPopBack(ShmList list, void* out)
+{
+    struct shmListHeader* hdr = list->hdr;
+    ShmListNode*          node;
+
+    pthread_rwlock_wrlock(&hdr->lock);
+    node = (ShmListNode*) relGet(&hdr->tail);
+    if (node)
+        shmListUnlinkNode(list, node, out);
+    pthread_rwlock_unlock(&hdr->lock);
+    return node != NULL;
+}
+
+int shmListPopFront(ShmList list, void* out)
+{
+    struct shmListHeader* hdr = list->hdr;
+    ShmListNode*          node;
+
+    pthread_rwlock_wrlock(&hdr->lock);
+    node = (ShmListNode*) relGet(&hdr->head);
+    if (node)
+        shmListUnlinkNode(list, node, out);
+    pthread_rwlock_unlock(&hdr->lock);
+    return node != NULL;
+}
+
+size_t shmListLength(ShmList list)
+{
+    size_t length;
+    pthread_rwlock_rdlock(&list->hdr->lock);
+    length = list->hdr->length;
+    pthread_rwlock_unlock(&list->hdr->lock);
+    return length;
+}
+
+size_t shmListValSize(ShmList list)
+{
+    return list->hdr->valsize;
+}
+
+void shmListReadLock(ShmList list)
+{
+    pthread_rwlock_rdlock(&list->hdr->lock);
+}
+
+void shmListReadUnlock(ShmList list)
+{
+    pthread_rwlock_unlock(&list->hdr->lock);
+}
+
+ShmListNode* shmListBegin(ShmList list)
+{
+    return (ShmListNode*) relGet(&list->hdr->head);
+}
+
+ShmListNode* shmListRBegin(ShmList list)
+{
+    return (ShmListNode*) relGet(&list->hdr->tail);
+}
+
+ShmListNode* shmListNext(ShmListNode* node)
+{
+    return (ShmListNode*) relGet(&node->n);
+}
+
+ShmListNode* shmListPrev(ShmListNode* node)
+{
+    return (ShmListNode*) relGet(&node->p);
+}
+
+void shmListForeach(ShmList list, void (*fun)(void*, void*), void* arg)
+{
+    ShmListNode* node;
+    shmListReadLock(list);
+    for (node = shmListBegin(list); node; node = shmListNext(node))
+        fun(node + 1, arg);
+    shmListReadUnlock(list);
+}
@@ -0,0 +1,67 @@
+/* File: shmlist.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _SHMLIST_H_
+#define _SHMLIST_H_
+
+#include <stddef.h>
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+/* The links are offsets relative to the field holding them, so a segment
+ * may be mapped at a different address in every process. */
+typedef struct shmListNode
+{
+    long n;                     /* offset to the next element, 0 if none */
+    long p;                     /* offset to the previous element, 0 if none */
+} ShmListNode;
+
+typedef struct shmList* ShmList;
+
+#define shmListVal(A, T) (*(T*) ((A) + 1))
+#define shmListRef(A, T) ( (T*) ((A) + 1))
+
+ShmList      shmListCreate      (const char* name, size_t capacity, size_t valsize);
+ShmList      shmListOpen        (const char* name);
+void         shmListClose       (ShmList list);
+int          shmListUnlink      (const char* name);
+
+int          shmListPushBack    (ShmList list, const void* val);
+int          shmListPushFront   (ShmList list, const void* val);
+int          shmListPopBack     (ShmList list, void* out);
+int          shmListPopFront    (ShmList list, void* out);
+size_t       shmListLength      (ShmList list);
+size_t       shmListValSize     (ShmList list);
+
+void         shmListReadLock    (ShmList list);
+void         shmListReadUnlock  (ShmList list);
+ShmListNode* shmListBegin       (ShmList list);
+ShmListNode* shmListRBegin      (ShmList list);
+ShmListNode* shmListNext        (ShmListNode* node);
+ShmListNode* shmListPrev        (ShmListNode* node);
+void         shmListForeach     (ShmList list, void (*fun)(void*, void*), void* arg);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
@@ -0,0 +1,291 @@
+/* File: wheel.c */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#include "wheel.h"
+#include <stdlib.h>
+
+#define WHEEL_BITS   8
+#define WHEEL_SLOTS  (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+#define WHEEL_WORDS  (WHEEL_SLOTS / 64)
+
+/*
+ * Each level has 256 buckets, each covering 256 times longer period than the
+ * ones of the level below. A timer goes to the lowest level on which its
+ * deadline shares all the higher bits with the current time. Whenever the
+ * lower levels wrap around, the current bucket of the next level is
+ * cascaded, its timers spread to the lower levels. The timers are list nodes
+ * linked straight into the buckets, so once they expire the whole bucket is
+ * moved to the caller's list at once. A bitmap of the non-empty buckets lets
+ * the wheel jump over the ticks on which nothing happens.
+ */
+struct wheelTimer
+{
+    struct list node;           /* must be the first member */
+    List        bucket;         /* NULL once expired */
+    uint64_t    deadline;
+};
+
+struct wheel
+{
+    uint64_t    now;
+    size_t      length;
+    struct list due;            /* the timers which were late when scheduled */
+    struct list overflow;       /* the timers beyond the highest level */
+    struct list buckets[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64_t    occupied[WHEEL_LEVELS][WHEEL_WORDS];
+};
+
+static void wheelRootInit(List root)
+{
+    root->isRoot = 1;
+    root->v      = NULL;
+    root->n      = NULL;
+    root->p      = NULL;
+}
+
+static List wheelBucket(Wheel wheel, uint64_t deadline)
+{
+    int level;
+    if (deadline <= wheel->now)
+        return &wheel->due;
+    for (level = 0; level < WHEEL_LEVELS; ++level)
+        if ((deadline ^ wheel->now) >> (WHEEL_BITS * (level + 1)) == 0)
+            return &wheel->buckets[level][(deadline >> (WHEEL_BITS * level))
+                                          & (WHEEL_SLOTS - 1)];
+    return &wheel->overflow;
+}
+
+/* updates the bitmap after the bucket has changed */
+static void wheelMark(Wheel wheel, List bucket)
+{
+    size_t    i = bucket - &wheel->buckets[0][0];
+    uint64_t* word;
+    uint64_t  bit;
+
+    if (bucket < &wheel->buckets[0][0] || i >= WHEEL_LEVELS * WHEEL_SLOTS)
+        return;                 /* due or overflow */
+    word = &wheel->occupied[i / WHEEL_SLOTS][i % WHEEL_SLOTS / 64];
+    bit  = (uint64_t) 1 << (i % 64);
+    if (listIsEmpty(bucket))
+        *word &= ~bit;
+    else
+        *word |= bit;
+}
+
+/* returns the first non-empty slot after the given one or -1 */
+static int wheelNextSlot(const uint64_t* occupied, size_t slot)
+{
+    size_t   word;
+    uint64_t mask;
+
+    if (++slot == WHEEL_SLOTS)
+        return -1;
+    word = slot / 64;
+    mask = occupied[word] & (~(uint64_t) 0 << (slot % 64));
+    while (mask == 0)
+    {
+        if (++word == WHEEL_WORDS)
+            return -1;
+        mask = occupied[word];
+    }
+    return word * 64 + __builtin_ctzll(mask);
+}
+
+/* returns the next time at which a bucket expires or is cascaded */
+static uint64_t wheelNextEvent(Wheel wheel)
+{
+    int level, slot, shift;
+    for (level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        shift = WHEEL_BITS * level;
+        slot = wheelNextSlot(wheel->occupied[level],
+                             (wheel->now >> shift) & (WHEEL_SLOTS - 1));
+        if (slot >= 0)
+            return (wheel->now >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS))
+                | (uint64_t) slot << shift;
+    }
+    if (listIsEmpty(&wheel->overflow))
+        return (uint64_t) -1;
+    shift = WHEEL_BITS * WHEEL_LEVELS;
+    if ((wheel->now >> shift) + 1 == (uint64_t) 1 << (64 - shift))
+        return (uint64_t) -1;
+    return ((wheel->now >> shift) + 1) << shift;
+}
+
+static void wheelPlace(Wheel wheel, WheelTimer timer)
+{
+    List bucket = wheelBucket(wheel, timer->deadline);
+    listLinkNode(bucket, listIsEmpty(bucket) ? bucket : listRBegin(bucket), &timer->node);
+    timer->bucket = bucket;
+    wheelMark(wheel, bucket);
+}
+
+static void wheelCascade(Wheel wheel, List bucket)
+{
+    struct list pendingRoot;
+    List        pending = &pendingRoot;
+    List        element;
+
+    wheelRootInit(pending);
+    listSplice(pending, bucket);
+    wheelMark(wheel, bucket);
+    while ((element = listBegin(pending)))
+    {
+        listUnlinkNode(pending, element);
+        wheelPlace(wheel, (WheelTimer) element);
+    }
+}
+
+static size_t wheelExpire(Wheel wheel, List bucket, List expired)
+{
+    size_t count = 0;
+    List   element;
+    for (element = listBegin(bucket); element; element = listNext(element))
+    {
+        ((WheelTimer) element)->bucket = NULL;
+        ++count;
+    }
+    listSplice(expired, bucket);
+    wheelMark(wheel, bucket);
+    wheel->length -= count;
+    return count;
+}
+
+static void wheelFreeBucket(List bucket)
+{
+    List element = listBegin(bucket);
+    List next;
+    for (; element; element = next)
+    {
+        next = listNext(element);
+        free(element);
+    }
+}
+
+Wheel wheelInit(uint64_t now)
+{
+    Wheel wheel = (Wheel) malloc(sizeof(struct wheel));
+    int   level, slot;
+    if (wheel == NULL)
+        return NULL;
+    wheel->now    = now;
+    wheel->length = 0;
+    wheelRootInit(&wheel->due);
+    wheelRootInit(&wheel->overflow);
+    for (level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        for (slot = 0; slot < WHEEL_SLOTS; ++slot)
+            wheelRootInit(&wheel->buckets[level][slot]);
+        for (slot = 0; slot < WHEEL_WORDS; ++slot)
+            wheel->occupied[level][slot] = 0;
+    }
+    return wheel;
+}
+
+/* frees the pending timers, but not their values */
+void wheelFree(Wheel wheel)
+{
+    int level, slot;
+    if (wheel == NULL)
+        return;
+    wheelFreeBucket(&wheel->due);
+    wheelFreeBucket(&wheel->overflow);
+    for (level = 0; level < WHEEL_LEVELS; ++level)
+        for (slot = 0; slot < WHEEL_SLOTS; ++slot)
+            wheelFreeBucket(&wheel->buckets[level][slot]);
+    free(wheel);
+}
+
+WheelTimer wheelSchedule(Wheel wheel, uint64_t deadline, void* val)
+{
+    WheelTimer timer = (WheelTimer) malloc(sizeof(struct wheelTimer));
+    if (timer == NULL)
+        return NULL;
+    timer->node.v   = val;
+    timer->deadline = deadline;
+    wheelPlace(wheel, timer);
+    ++wheel->length;
+    return timer;
+}
+
+/* returns NULL if the timer has already expired */
+void* wheelCancel(Wheel wheel, WheelTimer timer)
+{
+    void* val = timer->node.v;
+    if (timer->bucket == NULL)
+        return NULL;
+    listUnlinkNode(timer->bucket, &timer->node);
+    wheelMark(wheel, timer->bucket);
+    free(timer);
+    --wheel->length;
+    return val;
+}
+
+int wheelReschedule(Wheel wheel, WheelTimer timer, uint64_t deadline)
+{
+    if (timer->bucket == NULL)
+        return 0;               /* already expired */
+    listUnlinkNode(timer->bucket, &timer->node);
+    wheelMark(wheel, timer->bucket);
+    timer->deadline = deadline;
+    wheelPlace(wheel, timer);
+    return 1;
+}
+
+/* moves the timers expired by now to the end of expired, returns their number */
+size_t wheelAdvance(Wheel wheel, uint64_t now, List expired)
+{
+    size_t   count = wheelExpire(wheel, &wheel->due, expired);
+    uint64_t next;
+    size_t   slot;
+    int      level;
+
+    while (wheel->now < now)
+    {
+        next = wheelNextEvent(wheel);
+        if (next > now)
+        {
+            wheel->now = now;
+            break;
+        }
+
+        wheel->now = next;
+        slot       = next & (WHEEL_SLOTS - 1);
+        if (slot == 0)
+        {
+            for (level = 1; level < WHEEL_LEVELS; ++level)
+            {
+                size_t upper = (wheel->now >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+                wheelCascade(wheel, &wheel->buckets[level][upper]);
+                if (upper != 0)
+                    break;
+            }
+            if (level == WHEEL_LEVELS)
+                wheelCascade(wheel, &wheel->overflow);
+            count += wheelExpire(wheel, &wheel->due, expired);
+        }
+        count += wheelExpire(wheel, &wheel->buckets[0][slot], expired);
+    }
+    return count;
+}
+
+size_t wheelLength(Wheel wheel)
+{
+    return wheel->length;
+}
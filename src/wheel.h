@@ -0,0 +1,48 @@
+/* File: wheel.h */
+/*************************************************************************/
+/* Copyright (C) 2011-2012  Wojciech Siewierski                          */
+/*                                                                       */
+/* This program is free software: you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation, either version 3 of the License, or     */
+/* (at your option) any later version.                                   */
+/*                                                                       */
+/* This program is distributed in the hope that it will be useful,       */
+/* but WITHOUT ANY WARRANTY; without even the implied warranty of        */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         */
+/* GNU General Public License for more details.                          */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program.  If not, see <http://www.gnu.org/licenses/>. */
+/*************************************************************************/
+
+#ifndef _WHEEL_H_
+#define _WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "list.h"
+
+ #ifdef __cplusplus
+ extern "C"
+ {
+ #endif
+
+
+typedef struct wheel*      Wheel;
+typedef struct wheelTimer* WheelTimer;
+
+Wheel      wheelInit       (uint64_t now);
+void       wheelFree       (Wheel wheel);
+
+WheelTimer wheelSchedule   (Wheel wheel, uint64_t deadline, void* val);
+void*      wheelCancel     (Wheel wheel, WheelTimer timer);
+int        wheelReschedule (Wheel wheel, WheelTimer timer, uint64_t deadline);
+size_t     wheelAdvance    (Wheel wheel, uint64_t now, List expired);
+size_t     wheelLength     (Wheel wheel);
+
+
+ #ifdef __cplusplus
+ }
+ #endif
+#endif
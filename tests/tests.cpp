@@ -1,9 +1,20 @@
 // File: tests.cpp
 #include "tests.hpp"
 #include <list>
+#include <vector>
+#include <deque>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <iterator>
 #include <cstring>
 #include <ctime>
 #include <cstdlib>
+#include <cstdio>
+#include <unistd.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 CPPUNIT_TEST_SUITE_REGISTRATION(ListTest);
 
@@ -538,6 +549,1612 @@ void ListTest::sort()
     listForeach(l, freeint, NULL);
 }
 
+int isEven(const void* a, void*)
+{
+    return *(int*) a % 2 == 0;
+}
+void deleteint(void* a)
+{
+    delete (int*) a;
+}
+void ListTest::removeIf()
+{
+    for (int i = 0; i < 10; ++i)
+        listPushBack(l, (void*) new int(i));
+
+    CPPUNIT_ASSERT_EQUAL(5, listRemoveIf(l, isEven, NULL, deleteint));
+    CPPUNIT_ASSERT_EQUAL(5, listLength(l));
+
+    int expected = 1;
+    List p;
+    for (p = listBegin(l); p; p = listNext(p), expected += 2)
+        CPPUNIT_ASSERT_EQUAL(expected, listVal(p, int));
+    CPPUNIT_ASSERT_EQUAL(9, listVal(listRBegin(l), int));
+    CPPUNIT_ASSERT(listBegin(l)->p == NULL);
+
+    CPPUNIT_ASSERT_EQUAL(0, listRemoveIf(l, isEven, NULL, deleteint));
+    listForeach(l, freeint, NULL);
+}
+
+void ListTest::filter()
+{
+    int values[] = {8, 3, 4, 7, 6};
+    for (int i = 0; i < 5; ++i)
+        listPushBack(l, (void*) &values[i]);
+
+    List evens = listInit();
+    List first = listBegin(l);
+    CPPUNIT_ASSERT_EQUAL(3, listFilter(l, evens, isEven, NULL));
+
+    /* the nodes are moved, not copied */
+    CPPUNIT_ASSERT_EQUAL(first, listBegin(evens));
+    CPPUNIT_ASSERT(first->p == NULL);
+    CPPUNIT_ASSERT_EQUAL(6, listVal(listRBegin(evens), int));
+    CPPUNIT_ASSERT_EQUAL(4, listVal(listNext(listBegin(evens)), int));
+
+    CPPUNIT_ASSERT_EQUAL(2, listLength(l));
+    CPPUNIT_ASSERT_EQUAL(3, listVal(listBegin(l), int));
+    CPPUNIT_ASSERT_EQUAL(7, listVal(listRBegin(l), int));
+    CPPUNIT_ASSERT(listBegin(l)->p == NULL);
+    CPPUNIT_ASSERT(listRBegin(l)->n == NULL);
+    listFree(evens);
+}
+
+void ListTest::partition()
+{
+    int values[] = {1, 8, 3, 4, 7, 6};
+    for (int i = 0; i < 6; ++i)
+        listPushBack(l, (void*) &values[i]);
+
+    CPPUNIT_ASSERT_EQUAL(3, listPartition(l, isEven, NULL));
+
+    int expected[] = {8, 4, 6, 1, 3, 7};
+    List p = listBegin(l);
+    CPPUNIT_ASSERT(p->p == NULL);
+    for (int i = 0; i < 6; ++i, p = listNext(p))
+        CPPUNIT_ASSERT_EQUAL(expected[i], listVal(p, int));
+    CPPUNIT_ASSERT(p == NULL);
+    CPPUNIT_ASSERT_EQUAL(7, listVal(listRBegin(l), int));
+    CPPUNIT_ASSERT_EQUAL(3, listVal(listPrev(listRBegin(l)), int));
+}
+
+void ListTest::stats()
+{
+    int values[] = {3, 1, 2};
+    ListStats st;
+    for (int i = 0; i < 3; ++i)
+        listPushSort(l, (void*) &values[i], cmp);
+    int key = 3;
+    listGetVal(l, (void*) &key, cmp);
+    listGet(l, 1);
+    listRemoveN(l, 0);
+
+#ifdef LIST_STATS
+    CPPUNIT_ASSERT(listStats(l, &st));
+    CPPUNIT_ASSERT_EQUAL(4ul, st.allocs);   /* the root and three nodes */
+    CPPUNIT_ASSERT_EQUAL(1ul, st.frees);
+    CPPUNIT_ASSERT_EQUAL(3ul, st.calls[LIST_OP_PUSHSORT]);
+    CPPUNIT_ASSERT_EQUAL(3ul, st.traversed[LIST_OP_PUSHSORT]);
+    CPPUNIT_ASSERT_EQUAL(3ul, st.traversed[LIST_OP_GETVAL]);
+    CPPUNIT_ASSERT_EQUAL(6ul, st.compares);
+    CPPUNIT_ASSERT_EQUAL(2ul, st.calls[LIST_OP_GET]);
+    unsigned long timed = 0;
+    for (int i = 0; i < LIST_STAT_BUCKETS; ++i)
+        timed += st.latency[LIST_OP_GETVAL][i];
+    CPPUNIT_ASSERT_EQUAL(1ul, timed);
+
+    ListStats global;
+    listStatsGlobal(&global);
+    CPPUNIT_ASSERT(global.allocs >= st.allocs);
+#else
+    CPPUNIT_ASSERT(!listStats(l, &st));
+    CPPUNIT_ASSERT_EQUAL(0ul, st.allocs);
+#endif
+}
+
+void* statsThread(void*)
+{
+    List list = listInit();
+    for (int i = 0; i < 10000; ++i)
+        listPushBack(list, NULL);
+    listFree(list);
+    return NULL;
+}
+
+void ListTest::statsThreads()
+{
+    ListStats before, after;
+    pthread_t threads[4];
+    listStatsGlobal(&before);
+    for (int i = 0; i < 4; ++i)
+        pthread_create(&threads[i], NULL, statsThread, NULL);
+    for (int i = 0; i < 4; ++i)
+        pthread_join(threads[i], NULL);
+    listStatsGlobal(&after);
+
+#ifdef LIST_STATS
+    /* no update is lost, every list has the root and 10000 nodes */
+    CPPUNIT_ASSERT_EQUAL(4ul * 10001, after.allocs - before.allocs);
+    CPPUNIT_ASSERT_EQUAL(4ul * 10001, after.frees - before.frees);
+#else
+    CPPUNIT_ASSERT_EQUAL(0ul, after.allocs);
+#endif
+}
+
+struct Counts
+{
+    int allocs;
+    int frees;
+};
+void* countingAlloc(size_t size, void* ctx)
+{
+    ++((Counts*) ctx)->allocs;
+    return malloc(size);
+}
+void countingFree(void* ptr, void* ctx)
+{
+    if (ptr)
+        ++((Counts*) ctx)->frees;
+    free(ptr);
+}
+void ListTest::allocator()
+{
+    Counts counts = {0, 0};
+    ListAllocator alloc = {countingAlloc, countingFree, &counts};
+
+    List a = listInitWithAllocator(&alloc);
+    CPPUNIT_ASSERT(a != NULL);
+    int base = counts.allocs;
+    for (int i = 0; i < 4; ++i)
+        listPushBack(a, countingAlloc(sizeof(int), &counts));
+    CPPUNIT_ASSERT_EQUAL(base + 8, counts.allocs);
+
+    countingFree(listPopFront(a), &counts);
+    CPPUNIT_ASSERT_EQUAL(2, counts.frees);  /* the node and the value */
+
+    List c = listCopy(a);
+    CPPUNIT_ASSERT_EQUAL(2 * base + 8 + 3, counts.allocs);
+    listFree(c);
+    CPPUNIT_ASSERT_EQUAL(2 + base + 3, counts.frees);
+
+    listFreeDeep(a);
+    CPPUNIT_ASSERT_EQUAL(counts.allocs, counts.frees);
+}
+
+struct Budget
+{
+    int left;
+    int live;
+};
+void* budgetAlloc(size_t size, void* ctx)
+{
+    Budget* budget = (Budget*) ctx;
+    if (budget->left == 0)
+        return NULL;
+    --budget->left;
+    ++budget->live;
+    return malloc(size);
+}
+void budgetFree(void* ptr, void* ctx)
+{
+    --((Budget*) ctx)->live;
+    free(ptr);
+}
+void ListTest::allocatorFailure()
+{
+    Budget budget = {100, 0};
+    ListAllocator alloc = {budgetAlloc, budgetFree, &budget};
+    int values[] = {1, 2, 3, 4};
+
+    List a = listInitWithAllocator(&alloc);
+    for (int i = 0; i < 4; ++i)
+        CPPUNIT_ASSERT(listAddAfter(a, a, &values[i]) != NULL);
+    int used = budget.live;
+
+    /* the copy runs out of memory halfway and cleans up after itself */
+    budget.left = used - 2;
+    CPPUNIT_ASSERT(listCopy(a) == NULL);
+    CPPUNIT_ASSERT_EQUAL(used, budget.live);
+    budget.left = 1;
+    CPPUNIT_ASSERT(listCopy(a) == NULL);
+    CPPUNIT_ASSERT_EQUAL(used, budget.live);
+    CPPUNIT_ASSERT(listAddAfter(a, a, &values[0]) == NULL);
+    CPPUNIT_ASSERT_EQUAL(4, listLength(a));
+
+    budget.left = 100;
+    List c = listCopy(a);
+    CPPUNIT_ASSERT(c != NULL);
+    CPPUNIT_ASSERT_EQUAL(4, listLength(c));
+    listFree(c);
+    listFree(a);
+    CPPUNIT_ASSERT_EQUAL(0, budget.live);
+}
+
+void ListTest::shmRelocatable()
+{
+    char name[64];
+    sprintf(name, "/listtest-%d", (int) getpid());
+    shmListUnlink(name);
+
+    ShmList writer = shmListCreate(name, 16, sizeof(int));
+    CPPUNIT_ASSERT(writer != NULL);
+    for (int i = 0; i < 4; ++i)
+        CPPUNIT_ASSERT(shmListPushBack(writer, &i));
+    int i = -1;
+    CPPUNIT_ASSERT(shmListPushFront(writer, &i));
+
+    /* the second mapping lands at a different address */
+    ShmList reader = shmListOpen(name);
+    CPPUNIT_ASSERT(reader != NULL);
+    CPPUNIT_ASSERT(shmListBegin(reader) != shmListBegin(writer));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, shmListLength(reader));
+
+    shmListReadLock(reader);
+    int expected = -1;
+    ShmListNode* p;
+    for (p = shmListBegin(reader); p; p = shmListNext(p))
+    {
+        CPPUNIT_ASSERT_EQUAL(expected, shmListVal(p, int));
+        expected = expected < 0 ? 0 : expected + 1;
+    }
+    CPPUNIT_ASSERT_EQUAL(4, expected);
+    CPPUNIT_ASSERT_EQUAL(3, shmListVal(shmListRBegin(reader), int));
+    CPPUNIT_ASSERT_EQUAL(2, shmListVal(shmListPrev(shmListRBegin(reader)), int));
+    shmListReadUnlock(reader);
+
+    CPPUNIT_ASSERT(shmListPopBack(reader, &i));
+    CPPUNIT_ASSERT_EQUAL(3, i);
+    CPPUNIT_ASSERT(shmListPopFront(writer, &i));
+    CPPUNIT_ASSERT_EQUAL(-1, i);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, shmListLength(writer));
+
+    shmListClose(reader);
+    shmListClose(writer);
+    CPPUNIT_ASSERT(shmListUnlink(name));
+    CPPUNIT_ASSERT(shmListOpen(name) == NULL);
+}
+
+void ListTest::shmFull()
+{
+    char name[64];
+    sprintf(name, "/listtest-full-%d", (int) getpid());
+    shmListUnlink(name);
+
+    ShmList list = shmListCreate(name, 2, sizeof(int));
+    int a = 1;
+    CPPUNIT_ASSERT(shmListPushBack(list, &a));
+    CPPUNIT_ASSERT(shmListPushBack(list, &a));
+    CPPUNIT_ASSERT(!shmListPushBack(list, &a));
+    CPPUNIT_ASSERT(shmListPopFront(list, NULL));
+    CPPUNIT_ASSERT(shmListPushBack(list, &a));
+    CPPUNIT_ASSERT(shmListPopBack(list, NULL));
+    CPPUNIT_ASSERT(shmListPopBack(list, NULL));
+    CPPUNIT_ASSERT(!shmListPopBack(list, NULL));
+    CPPUNIT_ASSERT(shmListBegin(list) == NULL);
+
+    shmListClose(list);
+    shmListUnlink(name);
+}
+
+void ListTest::shmTruncated()
+{
+    char name[64];
+    sprintf(name, "/listtest-trunc-%d", (int) getpid());
+    shmListUnlink(name);
+
+    ShmList list = shmListCreate(name, 1024, sizeof(int));
+    CPPUNIT_ASSERT(list != NULL);
+    int fd = shm_open(name, O_RDWR, 0);
+    CPPUNIT_ASSERT(fd != -1);
+    CPPUNIT_ASSERT_EQUAL(0, ftruncate(fd, 4096));
+    close(fd);
+    CPPUNIT_ASSERT(shmListOpen(name) == NULL);
+
+    shmListClose(list);
+    shmListUnlink(name);
+    CPPUNIT_ASSERT(shmListCreate(name, (size_t) -1 / 2, sizeof(int)) == NULL);
+    CPPUNIT_ASSERT(shmListOpen(name) == NULL);
+}
+
+void ListTest::cowSnapshot()
+{
+    int values[200];
+    for (int i = 0; i < 200; ++i)
+    {
+        values[i] = i;
+        listPushBack(l, (void*) &values[i]);
+    }
+    CowList list = cowListFromList(l);
+    CPPUNIT_ASSERT_EQUAL((size_t) 200, cowListLength(list));
+
+    CowList snap = cowListSnapshot(list);
+    int x = -1;
+    CPPUNIT_ASSERT(cowListSet(list, 10, (void*) &x));
+    CPPUNIT_ASSERT(cowListPushFront(list, (void*) &x));
+    CPPUNIT_ASSERT_EQUAL(&values[199], (int*) cowListPopBack(list));
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 200, cowListLength(list));
+    CPPUNIT_ASSERT_EQUAL(&x, (int*) cowListGet(list, 0));
+    CPPUNIT_ASSERT_EQUAL(&x, (int*) cowListGet(list, 11));
+
+    /* the snapshot does not see any of it */
+    CPPUNIT_ASSERT_EQUAL((size_t) 200, cowListLength(snap));
+    for (int i = 0; i < 200; ++i)
+        CPPUNIT_ASSERT_EQUAL(&values[i], (int*) cowListGet(snap, i));
+    CPPUNIT_ASSERT(cowListGet(snap, 200) == NULL);
+
+    cowListFree(list);
+    CPPUNIT_ASSERT_EQUAL(&values[199], (int*) cowListGet(snap, 199));
+    cowListFree(snap);
+}
+
+void sumint(void* a, void* sum)
+{
+    *(long*) sum += *(int*) a;
+}
+void ListTest::cowInsertRemove()
+{
+    std::vector<int*> reference;
+    static int values[1000];
+    CowList list = cowListInit();
+    CowList snap = cowListSnapshot(list);
+    srand(time(NULL));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        values[i] = i;
+        size_t at = rand() % (reference.size() + 1);
+        reference.insert(reference.begin() + at, &values[i]);
+        CPPUNIT_ASSERT(cowListInsert(list, at, (void*) &values[i]));
+        if (i % 100 == 0)
+        {
+            cowListFree(snap);
+            snap = cowListSnapshot(list);
+        }
+    }
+    for (int i = 0; i < 300; ++i)
+    {
+        size_t at = rand() % reference.size();
+        reference.erase(reference.begin() + at);
+        CPPUNIT_ASSERT(cowListRemoveN(list, at));
+    }
+    CPPUNIT_ASSERT(!cowListRemoveN(list, reference.size()));
+    CPPUNIT_ASSERT(!cowListInsert(list, reference.size() + 1, NULL));
+
+    CPPUNIT_ASSERT_EQUAL(reference.size(), cowListLength(list));
+    long sum = 0, expected = 0;
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(reference[i], (int*) cowListGet(list, i));
+        expected += *reference[i];
+    }
+    cowListForeach(list, sumint, &sum);
+    CPPUNIT_ASSERT_EQUAL(expected, sum);
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 901, cowListLength(snap));
+    cowListFree(snap);
+    cowListFree(list);
+}
+
+void ListTest::cowLarge()
+{
+    std::vector<int*> reference;
+    static int values[100000];
+    CowList list = cowListInit();
+    for (int i = 0; i < 100000; ++i)
+    {
+        values[i] = i;
+        reference.push_back(&values[i]);
+        CPPUNIT_ASSERT(cowListPushBack(list, (void*) &values[i]));
+    }
+
+    /* deep enough for the path copying to matter */
+    CowList snap = cowListSnapshot(list);
+    for (int i = 0; i < 3000; ++i)
+    {
+        size_t at = rand() % reference.size();
+        switch (i % 3)
+        {
+        case 0:
+            reference.insert(reference.begin() + at, &values[i]);
+            CPPUNIT_ASSERT(cowListInsert(list, at, (void*) &values[i]));
+            break;
+        case 1:
+            reference.erase(reference.begin() + at);
+            CPPUNIT_ASSERT(cowListRemoveN(list, at));
+            break;
+        default:
+            reference[at] = &values[i];
+            CPPUNIT_ASSERT(cowListSet(list, at, (void*) &values[i]));
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(reference.size(), cowListLength(list));
+    for (size_t i = 0; i < reference.size(); ++i)
+        CPPUNIT_ASSERT_EQUAL(reference[i], (int*) cowListGet(list, i));
+    cowListFree(list);
+
+    for (int i = 0; i < 100000; ++i)
+        CPPUNIT_ASSERT_EQUAL(&values[i], (int*) cowListPopFront(snap));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, cowListLength(snap));
+    CPPUNIT_ASSERT(cowListPopBack(snap) == NULL);
+    cowListFree(snap);
+}
+
+void ListTest::dequeAgainstStd()
+{
+    std::deque<void*> reference;
+    Deque deque = dequeInit();
+    srand(time(NULL));
+
+    CPPUNIT_ASSERT(dequePopFront(deque) == NULL);
+    CPPUNIT_ASSERT(dequePopBack(deque) == NULL);
+    for (long i = 1; i < 20000; ++i)
+    {
+        switch (rand() % 5)
+        {
+        case 0:
+        case 1:
+            reference.push_back((void*) i);
+            CPPUNIT_ASSERT(dequePushBack(deque, (void*) i));
+            break;
+        case 2:
+            reference.push_front((void*) i);
+            CPPUNIT_ASSERT(dequePushFront(deque, (void*) i));
+            break;
+        case 3:
+            CPPUNIT_ASSERT_EQUAL(reference.empty() ? NULL : reference.back(),
+                                 dequePopBack(deque));
+            if (!reference.empty())
+                reference.pop_back();
+            break;
+        case 4:
+            CPPUNIT_ASSERT_EQUAL(reference.empty() ? NULL : reference.front(),
+                                 dequePopFront(deque));
+            if (!reference.empty())
+                reference.pop_front();
+            break;
+        }
+        CPPUNIT_ASSERT_EQUAL(reference.size(), dequeLength(deque));
+    }
+    CPPUNIT_ASSERT_EQUAL(reference.front(), dequeFront(deque));
+    CPPUNIT_ASSERT_EQUAL(reference.back(), dequeBack(deque));
+
+    dequeEmpty(deque);
+    CPPUNIT_ASSERT(dequeIsEmpty(deque));
+    CPPUNIT_ASSERT(dequePushFront(deque, (void*) 1));
+    CPPUNIT_ASSERT_EQUAL((void*) 1, dequePopBack(deque));
+    dequeFree(deque);
+}
+
+void ListTest::dequeCursor()
+{
+    Deque deque = dequeInit();
+    for (long i = 0; i < 1000; ++i)
+        dequePushBack(deque, (void*) i);
+    for (long i = -1; i >= -1000; --i)
+        dequePushFront(deque, (void*) i);
+
+    DequeCursor it;
+    void* val;
+    long expected = -1000;
+    dequeBegin(deque, &it);
+    while (dequeNext(&it, &val))
+    {
+        CPPUNIT_ASSERT_EQUAL((void*) expected, val);
+        expected = expected == -1 ? 0 : expected + 1;
+    }
+    CPPUNIT_ASSERT_EQUAL(1000l, expected);
+
+    long sum = 0;
+    for (int i = 0; i < 2000; ++i)
+        sum += (long) dequePopFront(deque);
+    CPPUNIT_ASSERT_EQUAL(-1000l, sum);
+    dequeBegin(deque, &it);
+    CPPUNIT_ASSERT(!dequeNext(&it, &val));
+    dequeFree(deque);
+}
+
+void ListTest::rankAgainstStd()
+{
+    std::vector<RankNode> reference;
+    RankList list = rankListInit();
+    srand(time(NULL));
+
+    for (long i = 0; i < 3000; ++i)
+    {
+        size_t at = rand() % (reference.size() + 1);
+        RankNode node = rankListInsert(list, at, (void*) i);
+        CPPUNIT_ASSERT(node != NULL);
+        reference.insert(reference.begin() + at, node);
+    }
+    CPPUNIT_ASSERT(rankListInsert(list, reference.size() + 1, NULL) == NULL);
+    for (int i = 0; i < 1000; ++i)
+    {
+        size_t at = rand() % reference.size();
+        if (i % 2)
+            CPPUNIT_ASSERT(rankListRemoveN(list, at));
+        else
+            rankListRemove(list, reference[at]);
+        reference.erase(reference.begin() + at);
+    }
+    CPPUNIT_ASSERT(!rankListRemoveN(list, reference.size()));
+
+    CPPUNIT_ASSERT_EQUAL(reference.size(), rankListLength(list));
+    for (size_t i = 0; i < reference.size(); ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL(reference[i], rankListGet(list, i));
+        CPPUNIT_ASSERT_EQUAL(i, rankListRank(reference[i]));
+    }
+    CPPUNIT_ASSERT(rankListGet(list, reference.size()) == NULL);
+    rankListFree(list);
+}
+
+void ListTest::rankIteration()
+{
+    int values[] = {1, 2, 3, 4, 5};
+    for (int i = 0; i < 5; ++i)
+        listPushBack(l, (void*) &values[i]);
+    RankList list = rankListFromList(l);
+    rankListPushFront(list, (void*) &values[4]);
+
+    int expected[] = {5, 1, 2, 3, 4, 5};
+    RankNode p = rankListBegin(list);
+    for (int i = 0; i < 6; ++i, p = rankListNext(p))
+        CPPUNIT_ASSERT_EQUAL(expected[i], rankListVal(p, int));
+    CPPUNIT_ASSERT(p == NULL);
+
+    p = rankListRBegin(list);
+    for (int i = 5; i >= 0; --i, p = rankListPrev(p))
+        CPPUNIT_ASSERT_EQUAL(expected[i], rankListVal(p, int));
+    CPPUNIT_ASSERT(p == NULL);
+
+    long sum = 0;
+    rankListForeach(list, sumint, &sum);
+    CPPUNIT_ASSERT_EQUAL(20l, sum);
+    rankListFree(list);
+}
+
+int destroyed = 0;
+void countDestroy(void* a)
+{
+    ++destroyed;
+    delete (int*) a;
+}
+void ListTest::rcuBasic()
+{
+    RcuList list = rcuListInit(2);
+    RcuReader reader = rcuListRegister(list);
+    CPPUNIT_ASSERT(reader != NULL);
+    CPPUNIT_ASSERT(rcuListRegister(list) != NULL);
+    CPPUNIT_ASSERT(rcuListRegister(list) == NULL);
+
+    for (int i = 0; i < 4; ++i)
+        rcuListPushBack(list, (void*) new int(i));
+    rcuListPushFront(list, (void*) new int(-1));
+
+    destroyed = 0;
+    int key = 2;
+    rcuListReadLock(list, reader);
+    RcuNode held = rcuListBegin(list);
+    while (rcuListVal(held, int) != 2)
+        held = rcuListNext(held);
+
+    /* the reader still holds the node, so it may not be freed yet */
+    CPPUNIT_ASSERT(rcuListRemoveVal(list, (void*) &key, cmp, countDestroy));
+    CPPUNIT_ASSERT_EQUAL(0, destroyed);
+    CPPUNIT_ASSERT_EQUAL(2, rcuListVal(held, int));
+    CPPUNIT_ASSERT_EQUAL(3, rcuListVal(rcuListNext(held), int));
+    CPPUNIT_ASSERT_EQUAL(1, rcuListReclaim(list));
+    rcuListReadUnlock(list, reader);
+
+    CPPUNIT_ASSERT_EQUAL(0, rcuListReclaim(list));
+    CPPUNIT_ASSERT_EQUAL(1, destroyed);
+
+    rcuListReadLock(list, reader);
+    CPPUNIT_ASSERT(rcuListGetVal(list, (void*) &key, cmp) == NULL);
+    key = 3;
+    CPPUNIT_ASSERT_EQUAL(3, *(int*) rcuListGetVal(list, (void*) &key, cmp));
+    rcuListReadUnlock(list, reader);
+
+    /* removing the tail keeps appending working */
+    CPPUNIT_ASSERT(rcuListRemoveVal(list, (void*) &key, cmp, countDestroy));
+    rcuListPushBack(list, (void*) new int(7));
+    long sum = 0;
+    rcuListForeach(list, reader, sumint, &sum);
+    CPPUNIT_ASSERT_EQUAL(7l, sum);
+
+    for (key = -1; key < 8; ++key)
+        rcuListRemoveVal(list, (void*) &key, cmp, countDestroy);
+    CPPUNIT_ASSERT(rcuListBegin(list) == NULL);
+    CPPUNIT_ASSERT_EQUAL(5, destroyed);
+    rcuListUnregister(list, reader);
+    rcuListFree(list);
+}
+
+struct RcuShared
+{
+    RcuList list;
+    int stop;
+};
+void* rcuReaderThread(void* arg)
+{
+    RcuShared* shared = (RcuShared*) arg;
+    RcuReader reader = rcuListRegister(shared->list);
+    long sum = 0;
+    while (!__atomic_load_n(&shared->stop, __ATOMIC_ACQUIRE))
+    {
+        rcuListReadLock(shared->list, reader);
+        for (RcuNode it = rcuListBegin(shared->list); it; it = rcuListNext(it))
+            sum += rcuListVal(it, int);
+        rcuListReadUnlock(shared->list, reader);
+    }
+    rcuListUnregister(shared->list, reader);
+    return (void*) sum;
+}
+void ListTest::rcuConcurrent()
+{
+    RcuShared shared;
+    shared.list = rcuListInit(4);
+    shared.stop = 0;
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i)
+        pthread_create(&threads[i], NULL, rcuReaderThread, &shared);
+
+    destroyed = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        rcuListPushBack(shared.list, (void*) new int(i));
+        if (i >= 16)
+        {
+            int key = i - 16;
+            CPPUNIT_ASSERT(rcuListRemoveVal(shared.list, (void*) &key, cmp, countDestroy));
+        }
+    }
+    __atomic_store_n(&shared.stop, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < 4; ++i)
+        pthread_join(threads[i], NULL);
+
+    CPPUNIT_ASSERT_EQUAL(0, rcuListReclaim(shared.list));
+    CPPUNIT_ASSERT_EQUAL(20000 - 16, destroyed);
+    for (int key = 20000 - 16; key < 20000; ++key)
+        CPPUNIT_ASSERT(rcuListRemoveVal(shared.list, (void*) &key, cmp, countDestroy));
+    rcuListFree(shared.list);
+    CPPUNIT_ASSERT_EQUAL(20000, destroyed);
+}
+
+void ListTest::pqueueOrder()
+{
+    std::list<int> sl;
+    srand(time(NULL));
+    for (int i = 0; i < 500; ++i)
+    {
+        int r = rand() % 1000;
+        sl.push_back(r);
+        listPushBack(l, (void*) new int(r));
+    }
+    PQueue queue = pqueueFromList(l, cmp);
+    CPPUNIT_ASSERT_EQUAL((size_t) 500, pqueueLength(queue));
+    for (int i = 0; i < 500; ++i)
+    {
+        int r = rand() % 1000;
+        sl.push_back(r);
+        listPushBack(l, (void*) new int(r));
+        pqueuePush(queue, l->p->v);
+    }
+    sl.sort();
+
+    for (std::list<int>::iterator it = sl.begin(); it != sl.end(); ++it)
+    {
+        CPPUNIT_ASSERT_EQUAL(*it, *(int*) pqueuePeek(queue));
+        CPPUNIT_ASSERT_EQUAL(*it, *(int*) pqueuePop(queue));
+    }
+    CPPUNIT_ASSERT(pqueueIsEmpty(queue));
+    CPPUNIT_ASSERT(pqueuePop(queue) == NULL);
+    pqueueFree(queue);
+    listForeach(l, freeint, NULL);
+}
+
+void ListTest::pqueueHandles()
+{
+    int values[100];
+    PQueueNode handles[100];
+    PQueue queue = pqueueInit(cmp);
+    for (int i = 0; i < 100; ++i)
+    {
+        values[i] = 1000 + i;
+        handles[i] = pqueuePush(queue, (void*) &values[i]);
+    }
+    /* pop one so that the heap gets some structure */
+    CPPUNIT_ASSERT_EQUAL(&values[0], (int*) pqueuePop(queue));
+
+    values[50] = 5;
+    pqueueDecreaseKey(queue, handles[50], (void*) &values[50]);
+    CPPUNIT_ASSERT_EQUAL(&values[50], (int*) pqueuePeek(queue));
+    values[70] = 3;
+    pqueueDecreaseKey(queue, handles[70], (void*) &values[70]);
+    pqueueRemove(queue, handles[1]);
+    pqueueRemove(queue, handles[70]);
+    pqueueRemove(queue, handles[99]);
+    CPPUNIT_ASSERT_EQUAL((size_t) 96, pqueueLength(queue));
+
+    CPPUNIT_ASSERT_EQUAL(5, *(int*) pqueuePop(queue));
+    int last = 0;
+    while (!pqueueIsEmpty(queue))
+    {
+        int v = *(int*) pqueuePop(queue);
+        CPPUNIT_ASSERT(v > last && v != 1001 && v != 1099);
+        last = v;
+    }
+    CPPUNIT_ASSERT_EQUAL(1098, last);
+    pqueueFree(queue);
+}
+
+void ListTest::moveNodes()
+{
+    int values[] = {1, 2, 3, 4};
+    for (int i = 0; i < 4; ++i)
+        listPushBack(l, (void*) &values[i]);
+    List first = listBegin(l);
+    List last = listRBegin(l);
+
+    listMoveToFront(l, last);
+    listMoveToBack(l, first);
+    /* 4 2 3 1 */
+    CPPUNIT_ASSERT_EQUAL(last, listBegin(l));
+    CPPUNIT_ASSERT_EQUAL(first, listRBegin(l));
+    CPPUNIT_ASSERT(last->p == NULL);
+    CPPUNIT_ASSERT(first->n == NULL);
+
+    listMoveAfter(l, last, first);
+    listMoveToBack(l, listRBegin(l));
+    listMoveToFront(l, listBegin(l));
+    int expected[] = {4, 1, 2, 3};
+    List p = listBegin(l);
+    for (int i = 0; i < 4; ++i, p = listNext(p))
+        CPPUNIT_ASSERT_EQUAL(expected[i], listVal(p, int));
+    p = listRBegin(l);
+    for (int i = 3; i >= 0; --i, p = listPrev(p))
+        CPPUNIT_ASSERT_EQUAL(expected[i], listVal(p, int));
+    CPPUNIT_ASSERT(p == NULL);
+}
+
+unsigned long hashint(const void* a)
+{
+    return *(int*) a * 2654435761u;
+}
+int evicted = 0;
+void evictint(void* key, void* val, void*)
+{
+    ++evicted;
+    delete (int*) key;
+    delete (int*) val;
+}
+void ListTest::lruCache()
+{
+    LruCache cache = lruInit(3, hashint, cmp, evictint, NULL);
+    evicted = 0;
+    for (int i = 0; i < 3; ++i)
+        CPPUNIT_ASSERT(lruPut(cache, (void*) new int(i), (void*) new int(i * 10)));
+
+    int key = 0;
+    CPPUNIT_ASSERT_EQUAL(0, *(int*) lruGet(cache, &key));
+    CPPUNIT_ASSERT(lruPut(cache, (void*) new int(3), (void*) new int(30)));
+    CPPUNIT_ASSERT_EQUAL(1, evicted);
+
+    /* 1 was the least recently used one */
+    key = 1;
+    CPPUNIT_ASSERT(lruGet(cache, &key) == NULL);
+    key = 2;
+    CPPUNIT_ASSERT_EQUAL(20, *(int*) lruGet(cache, &key));
+    key = 3;
+    CPPUNIT_ASSERT_EQUAL(30, *(int*) lruGet(cache, &key));
+    key = 0;
+    CPPUNIT_ASSERT_EQUAL(0, *(int*) lruGet(cache, &key));
+
+    CPPUNIT_ASSERT(lruPut(cache, (void*) new int(2), (void*) new int(21)));
+    CPPUNIT_ASSERT_EQUAL(2, evicted);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, lruLength(cache));
+    key = 2;
+    CPPUNIT_ASSERT_EQUAL(21, *(int*) lruGet(cache, &key));
+    CPPUNIT_ASSERT(lruRemove(cache, &key));
+    CPPUNIT_ASSERT(!lruRemove(cache, &key));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, lruLength(cache));
+
+    LruStats stats;
+    lruStats(cache, &stats);
+    CPPUNIT_ASSERT_EQUAL(5ul, stats.hits);
+    CPPUNIT_ASSERT_EQUAL(1ul, stats.misses);
+    CPPUNIT_ASSERT_EQUAL(1ul, stats.evictions);
+
+    lruFree(cache);
+    CPPUNIT_ASSERT_EQUAL(5, evicted);
+}
+
+void ListTest::lruSameKey()
+{
+    LruCache cache = lruInit(2, hashint, cmp, evictint, NULL);
+    evicted = 0;
+    int* key = new int(4);
+    CPPUNIT_ASSERT(lruPut(cache, (void*) key, (void*) new int(40)));
+    CPPUNIT_ASSERT(lruPut(cache, (void*) key, (void*) new int(41)));
+    CPPUNIT_ASSERT_EQUAL(1, evicted);
+    /* the key was not freed with the old value */
+    CPPUNIT_ASSERT_EQUAL(41, *(int*) lruGet(cache, key));
+    lruFree(cache);
+    CPPUNIT_ASSERT_EQUAL(2, evicted);
+}
+
+void ListTest::keyListLevels()
+{
+    srand(time(NULL));
+    std::vector<int64_t> keys;
+    for (int i = 0; i < 1000; ++i)
+        keys.push_back(rand() % 50 + ((int64_t) (rand() % 2) << 40));
+
+    for (int level = KEYLIST_SCALAR; level <= KEYLIST_AVX2; ++level)
+    {
+        KeyList list = keyListInit();
+        CPPUNIT_ASSERT(keyListUseSimd(list, level) <= level);
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (i % 2)
+                CPPUNIT_ASSERT(keyListPushBack(list, keys[i], (void*) i));
+            else
+                CPPUNIT_ASSERT(keyListPushFront(list, keys[i], (void*) i));
+        CPPUNIT_ASSERT_EQUAL(keys.size(), keyListLength(list));
+
+        for (int64_t key = 0; key < 50; key += 7)
+        {
+            size_t expected = 0;
+            for (size_t i = 0; i < keys.size(); ++i)
+                expected += keys[i] == key;
+            CPPUNIT_ASSERT_EQUAL(expected, keyListCount(list, key));
+
+            void* val = NULL;
+            CPPUNIT_ASSERT_EQUAL(expected > 0, keyListFind(list, key, &val) == 1);
+            if (expected)
+                CPPUNIT_ASSERT_EQUAL(key, keys[(size_t) val]);
+
+            CPPUNIT_ASSERT_EQUAL(expected, keyListRemoveKey(list, key));
+            CPPUNIT_ASSERT_EQUAL((size_t) 0, keyListCount(list, key));
+            CPPUNIT_ASSERT(!keyListFind(list, key, NULL));
+        }
+        CPPUNIT_ASSERT(!keyListFind(list, (int64_t) 1 << 41, NULL));
+
+        /* the order survives the removals */
+        std::vector<size_t> order;
+        for (size_t i = keys.size(); i-- > 0;)
+            if (i % 2 == 0 && (keys[i] >= 50 || keys[i] % 7))
+                order.push_back(i);
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (i % 2 && (keys[i] >= 50 || keys[i] % 7))
+                order.push_back(i);
+        CPPUNIT_ASSERT_EQUAL(order.size(), keyListLength(list));
+
+        KeyCursor it;
+        int64_t key;
+        void* val;
+        size_t n = 0;
+        keyListBegin(list, &it);
+        while (keyListNext(&it, &key, &val))
+        {
+            CPPUNIT_ASSERT_EQUAL(order[n], (size_t) val);
+            CPPUNIT_ASSERT_EQUAL(keys[order[n]], key);
+            ++n;
+        }
+        CPPUNIT_ASSERT_EQUAL(order.size(), n);
+        keyListFree(list);
+    }
+}
+
+void ListTest::getAt()
+{
+    for (int i = 0; i < 10; ++i)
+        listPushBack(l, new int(i));
+    CPPUNIT_ASSERT_EQUAL((size_t) 10, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(0, listVal(listGetAt(l, 0), int));
+    CPPUNIT_ASSERT_EQUAL(7, listVal(listGetAt(l, 7), int));
+    CPPUNIT_ASSERT(listGetAt(l, 10) == NULL);
+
+    delete listRef(listGetAt(l, 3), int);
+    CPPUNIT_ASSERT(listRemoveAt(l, 3));
+    CPPUNIT_ASSERT(!listRemoveAt(l, 9));
+    CPPUNIT_ASSERT_EQUAL((size_t) 9, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(4, listVal(listGetAt(l, 3), int));
+
+    listForeach(l, freeint, NULL);
+}
+
+void ListTest::arena()
+{
+    ListArena     arena = listArenaCreate(0, LIST_ARENA_THP | LIST_ARENA_HUGETLB);
+    ListAllocator allocator;
+    List          list;
+    List          first;
+    long          i;
+
+    CPPUNIT_ASSERT(arena);
+    listArenaAllocator(arena, &allocator);
+    list = listInitWithAllocator(&allocator);
+    CPPUNIT_ASSERT(list);
+    for (i = 0; i < 100000; ++i)
+        listPushBack(list, (void*) i);
+    CPPUNIT_ASSERT_EQUAL((size_t) 100000, listSize(list));
+    CPPUNIT_ASSERT_EQUAL(54321L, (long) listGetAt(list, 54321)->v);
+
+    /* the freed node is the next one handed out */
+    first = listBegin(list);
+    listRemove(list, first);
+    listPushFront(list, (void*) 42L);
+    CPPUNIT_ASSERT_EQUAL(first, listBegin(list));
+    CPPUNIT_ASSERT_EQUAL(42L, (long) listBegin(list)->v);
+    listFree(list);
+
+    /* the values are not the arena's, they go back with free */
+    list = listInitWithAllocator(&allocator);
+    for (i = 0; i < 100; ++i)
+        listPushBack(list, malloc(3 * sizeof(struct list)));
+    listFreeDeep(list);
+    listArenaDestroy(arena);
+}
+
+void ListTest::splice()
+{
+    List b = listInit();
+    for (long i = 0; i < 5; ++i)
+        listPushBack(l, (void*) i);
+    for (long i = 5; i < 10; ++i)
+        listPushBack(b, (void*) i);
+
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, listSpliceN(l, b, 2));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, listSpliceN(l, b, 0));
+    CPPUNIT_ASSERT_EQUAL((size_t) 7, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(7L, (long) listBegin(b)->v);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, listSpliceN(l, b, 10));
+    CPPUNIT_ASSERT(listIsEmpty(b));
+    CPPUNIT_ASSERT_EQUAL(9L, (long) listRBegin(l)->v);
+
+    listSplice(b, l);
+    CPPUNIT_ASSERT(listIsEmpty(l));
+    for (long i = 0; i < 10; ++i)
+        CPPUNIT_ASSERT_EQUAL(i, (long) listGetAt(b, i)->v);
+    for (long i = 9; i >= 0; --i)
+        CPPUNIT_ASSERT_EQUAL(i, (long) listPopBack(b));
+    listFree(b);
+}
+
+void ListTest::chan()
+{
+    Chan  chan  = chanInit(4);
+    void* val;
+    long  i;
+
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_TIMEOUT, chanRecv(chan, &val, 0));
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_TIMEOUT, chanRecvList(chan, l, 0, 10));
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_OK, chanSend(chan, (void*) 0L, 0));
+
+    /* only as many as fit are sent, the rest stays in the l */
+    for (i = 1; i < 6; ++i)
+        listPushBack(l, (void*) i);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_TIMEOUT, chanSendList(chan, l, 10));
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, chanLength(chan));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(4L, (long) listBegin(l)->v);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_TIMEOUT, chanSend(chan, (void*) 9L, 0));
+    listEmpty(l);
+
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_OK, chanRecv(chan, &val, -1));
+    CPPUNIT_ASSERT_EQUAL(0L, (long) val);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_OK, chanRecvList(chan, l, 2, -1));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(2L, (long) listRBegin(l)->v);
+
+    /* the closed channel is drained before reporting it */
+    chanClose(chan);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_CLOSED, chanSend(chan, (void*) 9L, -1));
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_CLOSED, chanSendList(chan, l, -1));
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_OK, chanRecvList(chan, l, 0, -1));
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, listSize(l));
+    CPPUNIT_ASSERT_EQUAL(3L, (long) listRBegin(l)->v);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_CLOSED, chanRecv(chan, &val, -1));
+
+    chanFree(chan);
+}
+
+struct ChanStage
+{
+    Chan in;
+    Chan out;
+};
+
+void* chanProducer(void* arg)
+{
+    Chan chan  = (Chan) arg;
+    List batch = listInit();
+    long i;
+    for (i = 1; i <= 10000; ++i)
+    {
+        listPushBack(batch, (void*) i);
+        if (i % 100 == 0)
+            chanSendList(chan, batch, -1);
+    }
+    listFree(batch);
+    return NULL;
+}
+
+void* chanDoubler(void* arg)
+{
+    ChanStage* stage = (ChanStage*) arg;
+    List       batch = listInit();
+    List       it;
+    while (chanRecvList(stage->in, batch, 64, -1) == CHAN_OK)
+    {
+        for (it = listBegin(batch); it; it = listNext(it))
+            it->v = (void*) (2 * (long) it->v);
+        chanSendList(stage->out, batch, -1);
+    }
+    chanClose(stage->out);
+    listFree(batch);
+    return NULL;
+}
+
+void ListTest::chanThreads()
+{
+    ChanStage stage;
+    pthread_t producers[2];
+    pthread_t doubler;
+    void*     val;
+    long      sum = 0;
+    int       i;
+
+    stage.in  = chanInit(256);
+    stage.out = chanInit(16);
+    for (i = 0; i < 2; ++i)
+        pthread_create(&producers[i], NULL, chanProducer, stage.in);
+    pthread_create(&doubler, NULL, chanDoubler, &stage);
+
+    for (i = 0; i < 2 * 10000; ++i)
+    {
+        CPPUNIT_ASSERT_EQUAL((int) CHAN_OK, chanRecv(stage.out, &val, -1));
+        sum += (long) val;
+    }
+    for (i = 0; i < 2; ++i)
+        pthread_join(producers[i], NULL);
+    chanClose(stage.in);
+    CPPUNIT_ASSERT_EQUAL((int) CHAN_CLOSED, chanRecv(stage.out, &val, -1));
+    pthread_join(doubler, NULL);
+
+    CPPUNIT_ASSERT_EQUAL(2 * 2 * 10000L * 10001 / 2, sum);
+    chanFree(stage.in);
+    chanFree(stage.out);
+}
+
+List sortedList(const std::vector<int>& values)
+{
+    List list = listInit();
+    for (size_t i = 0; i < values.size(); ++i)
+        listPushBack(list, (void*) new int(values[i]));
+    return list;
+}
+bool listEquals(List list, const std::vector<int>& values)
+{
+    size_t i = 0;
+    for (List it = listBegin(list); it; it = listNext(it), ++i)
+        if (i == values.size() || listVal(it, int) != values[i])
+            return false;
+    return i == values.size();
+}
+void ListTest::setOps()
+{
+    for (int round = 0; round < 20; ++round)
+    {
+        std::vector<int> a, b, expected;
+        for (int i = rand() % 200; i > 0; --i)
+            a.push_back(rand() % 50);
+        for (int i = rand() % 200; i > 0; --i)
+            b.push_back(rand() % 50);
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        List la, lb;
+
+        la = sortedList(a);
+        lb = sortedList(b);
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                       std::back_inserter(expected));
+        CPPUNIT_ASSERT_EQUAL(a.size() + b.size() - expected.size(),
+                             listUnion(la, lb, cmp, deleteint));
+        CPPUNIT_ASSERT(listEquals(la, expected));
+        CPPUNIT_ASSERT(listIsEmpty(lb));
+        CPPUNIT_ASSERT_EQUAL(listGetAt(la, expected.size() - 1), listRBegin(la));
+        listForeach(la, freeint, NULL);
+        listFree(la);
+        listFree(lb);
+        expected.clear();
+
+        la = sortedList(a);
+        lb = sortedList(b);
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                              std::back_inserter(expected));
+        CPPUNIT_ASSERT_EQUAL(a.size() - expected.size(), listIntersect(la, lb, cmp, deleteint));
+        CPPUNIT_ASSERT(listEquals(la, expected));
+        CPPUNIT_ASSERT(listEquals(lb, b));
+        listForeach(la, freeint, NULL);
+        listFree(la);
+        expected.clear();
+
+        la = sortedList(a);
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                            std::back_inserter(expected));
+        CPPUNIT_ASSERT_EQUAL(a.size() - expected.size(), listDifference(la, lb, cmp, deleteint));
+        CPPUNIT_ASSERT(listEquals(la, expected));
+        listForeach(la, freeint, NULL);
+        listFree(la);
+        listForeach(lb, freeint, NULL);
+        listFree(lb);
+
+        la = sortedList(a);
+        a.erase(std::unique(a.begin(), a.end()), a.end());
+        listUnique(la, cmp, deleteint);
+        CPPUNIT_ASSERT(listEquals(la, a));
+        listForeach(la, freeint, NULL);
+        listFree(la);
+    }
+}
+
+int pairWrite(FILE* stream, const void* val, void*)
+{
+    return fwrite(val, sizeof(int), 2, stream) == 2;
+}
+void* pairRead(FILE* stream, void*)
+{
+    int* pair = (int*) malloc(2 * sizeof(int));
+    if (fread(pair, sizeof(int), 2, stream) != 2)
+    {
+        free(pair);
+        return NULL;
+    }
+    return pair;
+}
+size_t pairSize(const void*, void*)
+{
+    return 2 * sizeof(int);
+}
+void pairDestroy(void* val, void*)
+{
+    free(val);
+}
+int pairCount(void* val, void* count)
+{
+    free(val);
+    return ++*(int*) count < 100;
+}
+List pairList(int n, int keys)
+{
+    List list = listInit();
+    for (int i = 0; i < n; ++i)
+    {
+        int* pair = (int*) malloc(2 * sizeof(int));
+        pair[0] = rand() % keys;
+        pair[1] = i;
+        listPushBack(list, pair);
+    }
+    return list;
+}
+void ListTest::externalSort()
+{
+    ListSerializer serializer = { pairWrite, pairRead, pairSize, pairDestroy, NULL };
+    size_t budgets[] = { 0, 50 * (sizeof(struct list) + 2 * sizeof(int)), 1 << 20 };
+
+    for (int b = 0; b < 3; ++b)
+    {
+        List list = pairList(5000, 100);
+        CPPUNIT_ASSERT(listSortExternal(list, cmp, &serializer, budgets[b]));
+        CPPUNIT_ASSERT_EQUAL((size_t) 5000, listSize(list));
+        for (List it = listBegin(list); listNext(it); it = listNext(it))
+        {
+            int* a = listRef(it, int);
+            int* c = listRef(listNext(it), int);
+            CPPUNIT_ASSERT(a[0] < c[0] || (a[0] == c[0] && a[1] < c[1]));
+        }
+        listFreeDeep(list);
+    }
+}
+
+void ListTest::externalSortForeach()
+{
+    int            count = 0;
+    ListSerializer serializer = { pairWrite, pairRead, pairSize, pairDestroy, NULL };
+    ExtSort        sort = extSortInit(cmp, &serializer, 1000);
+    List           list = pairList(1000, 1000);
+
+    CPPUNIT_ASSERT(extSortPushList(sort, list));
+    CPPUNIT_ASSERT(listIsEmpty(list));
+    CPPUNIT_ASSERT(extSortRuns(sort) > 1);
+
+    /* the values not passed to the callback are destroyed by the sorter */
+    CPPUNIT_ASSERT(!extSortForeach(sort, pairCount, &count));
+    CPPUNIT_ASSERT_EQUAL(100, count);
+    extSortFree(sort);
+
+    listFree(list);
+}
+
+std::string viewString(List element)
+{
+    return std::string(listViewOf(element)->data, listViewOf(element)->len);
+}
+std::string writeTemp(const char* contents)
+{
+    char  path[] = "/tmp/listloadXXXXXX";
+    int   fd     = mkstemp(path);
+    FILE* file   = fdopen(fd, "w");
+    fputs(contents, file);
+    fclose(file);
+    return path;
+}
+void ListTest::loadLines()
+{
+    std::string path = writeTemp("first\n\nthird line\nlast");
+    List        list = listLoadLines(path.c_str(), '\n');
+    ListView    extra = { "extra", 5 };
+
+    CPPUNIT_ASSERT(list);
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, listSize(list));
+    CPPUNIT_ASSERT_EQUAL(std::string("first"), viewString(listGetAt(list, 0)));
+    CPPUNIT_ASSERT_EQUAL(std::string(""), viewString(listGetAt(list, 1)));
+    CPPUNIT_ASSERT_EQUAL(std::string("third line"), viewString(listGetAt(list, 2)));
+    CPPUNIT_ASSERT_EQUAL(std::string("last"), viewString(listRBegin(list)));
+
+    /* the list stays an ordinary one */
+    listRemoveAt(list, 1);
+    listPushBack(list, &extra);
+    CPPUNIT_ASSERT_EQUAL(std::string("extra"), viewString(listRBegin(list)));
+
+    /* the copy does not depend on the loader itself */
+    List copy = listCopy(list);
+    CPPUNIT_ASSERT_EQUAL(std::string("third line"), viewString(listGetAt(copy, 1)));
+    listUnload(list);
+    CPPUNIT_ASSERT(listRemoveAt(copy, 0));
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, listSize(copy));
+    listFree(copy);
+
+    list = listLoadLines(path.c_str(), ' ');
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, listSize(list));
+    CPPUNIT_ASSERT_EQUAL(std::string("line\nlast"), viewString(listRBegin(list)));
+    listUnload(list);
+    unlink(path.c_str());
+
+    path = writeTemp("");
+    list = listLoadLines(path.c_str(), '\n');
+    CPPUNIT_ASSERT(list && listIsEmpty(list));
+    listUnload(list);
+    unlink(path.c_str());
+
+    CPPUNIT_ASSERT(listLoadLines(path.c_str(), '\n') == NULL);
+}
+
+void ListTest::loadRecords()
+{
+    std::string path = writeTemp("aaaabbbbccccdd");
+    List        list = listLoadRecords(path.c_str(), 4);
+
+    CPPUNIT_ASSERT(list);
+    CPPUNIT_ASSERT_EQUAL((size_t) 4, listSize(list));
+    CPPUNIT_ASSERT_EQUAL(std::string("bbbb"), viewString(listGetAt(list, 1)));
+    CPPUNIT_ASSERT_EQUAL(std::string("dd"), viewString(listRBegin(list)));
+    listUnload(list);
+
+    /* listFree unmaps the file as well */
+    list = listLoadRecords(path.c_str(), 3);
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, listSize(list));
+    listRemoveAt(list, 2);
+    listPushFront(list, NULL);
+    listFree(list);
+
+    CPPUNIT_ASSERT(listLoadRecords(path.c_str(), 0) == NULL);
+    unlink(path.c_str());
+}
+
+uint64_t randomId()
+{
+    return (uint64_t) rand() << 31 ^ (uint64_t) rand();
+}
+void ListTest::packList()
+{
+    PackList           list = packListInit();
+    std::set<uint64_t> reference;
+    PackCursor         it;
+    uint64_t           val;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint64_t id = i % 3 ? rand() % 100000 : randomId();
+        CPPUNIT_ASSERT_EQUAL(reference.insert(id).second, packListInsert(list, id) == 1);
+    }
+    CPPUNIT_ASSERT_EQUAL(reference.size(), packListLength(list));
+
+    packListBegin(list, &it);
+    for (std::set<uint64_t>::iterator ref = reference.begin(); ref != reference.end(); ++ref)
+    {
+        CPPUNIT_ASSERT(packListNext(&it, &val));
+        CPPUNIT_ASSERT_EQUAL(*ref, val);
+    }
+    CPPUNIT_ASSERT(!packListNext(&it, &val));
+
+    for (uint64_t id = 0; id < 1000; ++id)
+        CPPUNIT_ASSERT_EQUAL(reference.count(id) == 1, packListContains(list, id) == 1);
+
+    packListBegin(list, &it);
+    CPPUNIT_ASSERT(packListSeek(&it, 50000, &val));
+    CPPUNIT_ASSERT_EQUAL(*reference.lower_bound(50000), val);
+    CPPUNIT_ASSERT(packListNext(&it, &val));
+    CPPUNIT_ASSERT_EQUAL(*reference.upper_bound(*reference.lower_bound(50000)), val);
+    CPPUNIT_ASSERT(!packListSeek(&it, *reference.rbegin() + 1, &val));
+    packListFree(list);
+
+    /* consecutive IDs take little more than a byte each */
+    list = packListInit();
+    for (uint64_t id = 1000000; id < 1100000; id += 1 + rand() % 4)
+        CPPUNIT_ASSERT(packListAppend(list, id));
+    CPPUNIT_ASSERT(!packListAppend(list, 1000000));
+    CPPUNIT_ASSERT(packListBytes(list) < 2 * packListLength(list));
+    packListFree(list);
+}
+
+void ListTest::packListIntersection()
+{
+    PackList              a = packListInit();
+    PackList              b = packListInit();
+    PackList              both;
+    std::vector<uint64_t> va, vb, expected;
+    PackCursor            it;
+    uint64_t              val;
+
+    for (uint64_t id = 0; id < 200000; id += 1 + rand() % 3)
+    {
+        packListAppend(a, id);
+        va.push_back(id);
+    }
+    for (uint64_t id = 0; id < 200000; id += 1 + rand() % 5000)
+    {
+        packListAppend(b, id);
+        vb.push_back(id);
+    }
+    std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(),
+                          std::back_inserter(expected));
+
+    both = packListIntersect(a, b);
+    CPPUNIT_ASSERT_EQUAL(expected.size(), packListLength(both));
+    packListBegin(both, &it);
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        CPPUNIT_ASSERT(packListNext(&it, &val));
+        CPPUNIT_ASSERT_EQUAL(expected[i], val);
+    }
+
+    packListFree(both);
+    packListFree(a);
+    packListFree(b);
+}
+
+void ListTest::wheel()
+{
+    const size_t            count = 20000;
+    std::vector<uint64_t>   deadlines(count);
+    std::vector<WheelTimer> timers(count);
+    std::vector<int>        fired(count, 0);
+    uint64_t                now = 1000;
+    Wheel                   wheel = wheelInit(now);
+    size_t                  cancelled = 0;
+    size_t                  i;
+
+    for (i = 0; i < count; ++i)
+    {
+        switch (i % 4)
+        {
+        case 0:  deadlines[i] = now + 1 + rand() % 300;           break;
+        case 1:  deadlines[i] = now + 1 + rand() % 100000;        break;
+        case 2:  deadlines[i] = now + 1 + (uint64_t) rand() * 16; break;
+        default: deadlines[i] = now + ((uint64_t) 1 << 33) + rand() % 1000;
+        }
+        timers[i] = wheelSchedule(wheel, deadlines[i], (void*) i);
+        CPPUNIT_ASSERT(timers[i]);
+    }
+    for (i = 0; i < count; i += 7)
+    {
+        CPPUNIT_ASSERT_EQUAL((void*) i, wheelCancel(wheel, timers[i]));
+        fired[i] = -1;
+        ++cancelled;
+    }
+    for (i = 3; i < count; i += 14)
+    {
+        deadlines[i] = now + 1 + rand() % 5000;
+        CPPUNIT_ASSERT(wheelReschedule(wheel, timers[i], deadlines[i]));
+    }
+    CPPUNIT_ASSERT_EQUAL(count - cancelled, wheelLength(wheel));
+
+    /* every timer expires exactly at the first advance past its deadline */
+    while (wheelLength(wheel) > 0)
+    {
+        uint64_t previous = now;
+        now += rand() % 3 ? rand() % 1000 : (uint64_t) rand() * 64;
+        size_t n = wheelAdvance(wheel, now, l);
+        CPPUNIT_ASSERT_EQUAL(listSize(l), n);
+        for (List it = listBegin(l); it; it = listNext(it))
+        {
+            size_t id = (size_t) it->v;
+            CPPUNIT_ASSERT_EQUAL(0, fired[id]);
+            CPPUNIT_ASSERT(deadlines[id] > previous && deadlines[id] <= now);
+            fired[id] = 1;
+        }
+        listEmpty(l);
+    }
+    for (i = 0; i < count; ++i)
+        CPPUNIT_ASSERT(fired[i] != 0);
+
+    /* late timers expire on the next advance, in the order of scheduling */
+    WheelTimer late = wheelSchedule(wheel, now - 10, (void*) 1);
+    wheelSchedule(wheel, now - 20, (void*) 2);
+    CPPUNIT_ASSERT(wheelReschedule(wheel, late, now - 5));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, wheelAdvance(wheel, now, l));
+    CPPUNIT_ASSERT_EQUAL((void*) 2, listBegin(l)->v);
+    CPPUNIT_ASSERT_EQUAL((void*) 1, listRBegin(l)->v);
+
+    /* the expired timers are left alone */
+    CPPUNIT_ASSERT(wheelCancel(wheel, late) == NULL);
+    CPPUNIT_ASSERT(!wheelReschedule(wheel, late, now + 5));
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, wheelLength(wheel));
+    wheelSchedule(wheel, now + 5, NULL);
+    wheelFree(wheel);
+}
+
+void ListTest::clist()
+{
+    CList list = clistInit();
+    CList copy;
+    int   values[] = { 0, 1, 2, 3, 4, 5 };
+
+    CPPUNIT_ASSERT(clistIsEmpty(list));
+    CPPUNIT_ASSERT(clistPopFront(list) == NULL);
+    CPPUNIT_ASSERT(clistPopBack(list) == NULL);
+    CPPUNIT_ASSERT(clistGet(list, 0) == NULL);
+
+    CPPUNIT_ASSERT(clistPushBack(list, &values[2]));
+    CPPUNIT_ASSERT(clistPushFront(list, &values[0]));
+    CPPUNIT_ASSERT(clistPushSort(list, &values[1], cmp));
+    CPPUNIT_ASSERT(clistPushSort(list, &values[4], cmp));
+    CPPUNIT_ASSERT(clistAddAfter(clistGet(list, 2), &values[3]));
+    CPPUNIT_ASSERT_EQUAL((size_t) 5, clistLength(list));
+    for (int i = 0; i < 5; ++i)
+        CPPUNIT_ASSERT_EQUAL(i, clistVal(clistGet(list, i), int));
+    CPPUNIT_ASSERT(clistGet(list, 5) == NULL);
+    CPPUNIT_ASSERT_EQUAL(4, clistVal(clistRBegin(list), int));
+    CPPUNIT_ASSERT_EQUAL(clistEnd(list), clistNext(clistRBegin(list)));
+
+    copy = clistCopy(list);
+    CPPUNIT_ASSERT(clistSwap(copy, clistBegin(copy)));
+    CPPUNIT_ASSERT(!clistSwap(copy, clistRBegin(copy)));
+    CPPUNIT_ASSERT_EQUAL(1, clistVal(clistBegin(copy), int));
+    CPPUNIT_ASSERT_EQUAL(0, clistVal(clistBegin(list), int));
+    clistMoveAfter(clistRBegin(copy), clistBegin(copy));
+    CPPUNIT_ASSERT_EQUAL(1, clistVal(clistRBegin(copy), int));
+    CPPUNIT_ASSERT(clistRemoveVal(copy, &values[4], cmp));
+    CPPUNIT_ASSERT(!clistRemoveVal(copy, &values[5], cmp));
+    CPPUNIT_ASSERT(clistRemoveN(copy, 0));
+    CPPUNIT_ASSERT(!clistRemoveN(copy, 3));
+    CPPUNIT_ASSERT_EQUAL(2, *(int*) clistPopFront(copy));
+    CPPUNIT_ASSERT_EQUAL(1, *(int*) clistPopBack(copy));
+    CPPUNIT_ASSERT_EQUAL(3, *(int*) clistPopBack(copy));
+    CPPUNIT_ASSERT(clistIsEmpty(copy));
+    clistFree(copy);
+
+    clistRemove(clistGet(list, 1));
+    clistRemove(clistBegin(list));
+    clistRemove(clistRBegin(list));
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, clistLength(list));
+    CPPUNIT_ASSERT_EQUAL(2, clistVal(clistBegin(list), int));
+    CPPUNIT_ASSERT_EQUAL(3, clistVal(clistRBegin(list), int));
+    clistEmpty(list);
+    CPPUNIT_ASSERT(clistIsEmpty(list));
+    clistFree(list);
+}
+
+void ListTest::clistMergeSort()
+{
+    std::vector<std::pair<int, int> > reference;
+    CList list = clistInit();
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        int* val = (int*) malloc(2 * sizeof(int));
+        val[0] = rand() % 100;
+        val[1] = i;
+        clistPushBack(list, val);
+        reference.push_back(std::make_pair(val[0], i));
+    }
+    clistSort(list, cmp);
+    std::sort(reference.begin(), reference.end());
+
+    /* stable and linked both ways */
+    CList it = clistBegin(list);
+    for (size_t i = 0; i < reference.size(); ++i, it = clistNext(it))
+    {
+        CPPUNIT_ASSERT_EQUAL(reference[i].first, clistRef(it, int)[0]);
+        CPPUNIT_ASSERT_EQUAL(reference[i].second, clistRef(it, int)[1]);
+        CPPUNIT_ASSERT_EQUAL(it, clistNext(clistPrev(it)));
+    }
+    CPPUNIT_ASSERT_EQUAL(clistEnd(list), it);
+    CPPUNIT_ASSERT_EQUAL(clistRBegin(list), clistPrev(it));
+    clistFreeDeep(list);
+}
+
+void ListTest::fixedList()
+{
+    static struct list buffer[LIST_FIXED_SLOTS(5)];
+    int                values[] = { 4, 2, 3, 0, 1, 5 };
+    List               list = listInitFixed(buffer, sizeof(buffer));
+    int                i;
+
+    CPPUNIT_ASSERT(list);
+    for (i = 0; i < 5; ++i)
+        CPPUNIT_ASSERT(listPushBack(list, &values[i]));
+    CPPUNIT_ASSERT(!listPushBack(list, &values[5]));
+    CPPUNIT_ASSERT(!listPushFront(list, &values[5]));
+    CPPUNIT_ASSERT(!listPushSort(list, &values[5], cmp));
+    CPPUNIT_ASSERT(listAddAfter(list, list, &values[5]) == NULL);
+    CPPUNIT_ASSERT_EQUAL(5, listLength(list));
+
+    listSort(list, cmp);
+    for (i = 0; i < 5; ++i)
+        CPPUNIT_ASSERT_EQUAL(i, listVal(listGetAt(list, i), int));
+
+    /* the freed nodes are reused */
+    CPPUNIT_ASSERT_EQUAL(4, *(int*) listPopBack(list));
+    CPPUNIT_ASSERT(listPushSort(list, &values[5], cmp));
+    CPPUNIT_ASSERT_EQUAL(5, listVal(listRBegin(list), int));
+    CPPUNIT_ASSERT(listGetAt(list, 0) >= buffer && listGetAt(list, 0) < buffer + LIST_FIXED_SLOTS(5));
+
+    /* the copy of a full list does not come from its buffer */
+    List copy = listCopy(list);
+    CPPUNIT_ASSERT(copy != NULL);
+    CPPUNIT_ASSERT(copy < buffer || copy >= buffer + LIST_FIXED_SLOTS(5));
+    CPPUNIT_ASSERT(listPushBack(copy, &values[0]));
+    CPPUNIT_ASSERT_EQUAL(6, listLength(copy));
+    listFree(list);
+    memset(buffer, 0, sizeof(buffer));
+    CPPUNIT_ASSERT_EQUAL(0, listVal(listBegin(copy), int));
+    CPPUNIT_ASSERT_EQUAL(4, listVal(listRBegin(copy), int));
+    listFree(copy);
+
+    /* the values are freed, the buffer is left alone */
+    list = listInitFixed(buffer, sizeof(buffer));
+    for (i = 0; i < 5; ++i)
+        CPPUNIT_ASSERT(listPushBack(list, malloc(sizeof(int))));
+    listFreeDeep(list);
+
+    CPPUNIT_ASSERT(listInitFixed(buffer, sizeof(struct list)) == NULL);
+}
+
+void ListTest::fixedListWrapper()
+{
+    FixedList<3> list;
+    int          values[] = { 3, 1, 2, 4 };
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 3, (std::size_t) FixedList<3>::capacity);
+    CPPUNIT_ASSERT(list.empty());
+    CPPUNIT_ASSERT(list.pushBack(&values[0]));
+    CPPUNIT_ASSERT(list.pushBack(&values[1]));
+    CPPUNIT_ASSERT(list.pushFront(&values[2]));
+    CPPUNIT_ASSERT(!list.pushBack(&values[3]));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 3, list.size());
+
+    listSort(list, cmp);
+    CPPUNIT_ASSERT_EQUAL(1, *(int*) list.popFront());
+    CPPUNIT_ASSERT_EQUAL(3, *(int*) list.popBack());
+    CPPUNIT_ASSERT(list.pushBack(&values[3]));
+    List root = list;
+    CPPUNIT_ASSERT_EQUAL(4, listVal(listRBegin(root), int));
+}
+
 #ifdef _REGEX_H
 int regexMatch(const void* a, const void* re)
 {
@@ -621,4 +2238,34 @@ void ListTest::regexDelete()
     CPPUNIT_ASSERT(p == NULL);
     regfree(&regex);
 }
+int regexMatches(const void* a, void* re)
+{
+    return !regexec((regex_t*) re, (char*) a, 0, NULL, 0);
+}
+void ListTest::regexRemoveIf()
+{
+    listPushBack(l, (void*) "foo");
+    listPushBack(l, (void*) "bar");
+    listPushBack(l, (void*) "baz");
+    listPushBack(l, (void*) "qux");
+
+    regex_t regex;
+    CPPUNIT_ASSERT(!regcomp(&regex, "^ba.$", 0));
+    CPPUNIT_ASSERT_EQUAL(2, listRemoveIf(l, regexMatches, (void*) &regex, NULL));
+    regfree(&regex);
+
+    List p = listBegin(l);
+    CPPUNIT_ASSERT(!strcmp("foo", &listVal(p, char)));
+    p = listNext(p);
+    CPPUNIT_ASSERT(!strcmp("qux", &listVal(p, char)));
+    CPPUNIT_ASSERT_EQUAL(p, listRBegin(l));
+    p = listNext(p);
+    CPPUNIT_ASSERT(p == NULL);
+
+    CPPUNIT_ASSERT(!regcomp(&regex, ".", 0));
+    CPPUNIT_ASSERT_EQUAL(2, listRemoveIf(l, regexMatches, (void*) &regex, NULL));
+    regfree(&regex);
+    CPPUNIT_ASSERT(listIsEmpty(l));
+    CPPUNIT_ASSERT(listRBegin(l) == NULL);
+}
 #endif
@@ -6,6 +6,21 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <regex.h>
 #include "../src/list.h"
+#include "../src/shmlist.h"
+#include "../src/cowlist.h"
+#include "../src/deque.h"
+#include "../src/ranklist.h"
+#include "../src/rculist.h"
+#include "../src/pqueue.h"
+#include "../src/lru.h"
+#include "../src/keylist.h"
+#include "../src/chan.h"
+#include "../src/extsort.h"
+#include "../src/loader.h"
+#include "../src/packlist.h"
+#include "../src/wheel.h"
+#include "../src/clist.h"
+#include "../src/fixedlist.hpp"
 
 class ListTest : public CPPUNIT_NS::TestFixture
 {
@@ -33,9 +48,52 @@ class ListTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST(swapFirst);
     CPPUNIT_TEST(swapFail);
     CPPUNIT_TEST(sort);
+    CPPUNIT_TEST(removeIf);
+    CPPUNIT_TEST(filter);
+    CPPUNIT_TEST(partition);
+    CPPUNIT_TEST(stats);
+    CPPUNIT_TEST(statsThreads);
+    CPPUNIT_TEST(allocator);
+    CPPUNIT_TEST(allocatorFailure);
+    CPPUNIT_TEST(shmRelocatable);
+    CPPUNIT_TEST(shmFull);
+    CPPUNIT_TEST(shmTruncated);
+    CPPUNIT_TEST(cowSnapshot);
+    CPPUNIT_TEST(cowInsertRemove);
+    CPPUNIT_TEST(cowLarge);
+    CPPUNIT_TEST(dequeAgainstStd);
+    CPPUNIT_TEST(dequeCursor);
+    CPPUNIT_TEST(rankAgainstStd);
+    CPPUNIT_TEST(rankIteration);
+    CPPUNIT_TEST(rcuBasic);
+    CPPUNIT_TEST(rcuConcurrent);
+    CPPUNIT_TEST(pqueueOrder);
+    CPPUNIT_TEST(pqueueHandles);
+    CPPUNIT_TEST(moveNodes);
+    CPPUNIT_TEST(lruCache);
+    CPPUNIT_TEST(lruSameKey);
+    CPPUNIT_TEST(keyListLevels);
+    CPPUNIT_TEST(getAt);
+    CPPUNIT_TEST(arena);
+    CPPUNIT_TEST(splice);
+    CPPUNIT_TEST(chan);
+    CPPUNIT_TEST(chanThreads);
+    CPPUNIT_TEST(setOps);
+    CPPUNIT_TEST(externalSort);
+    CPPUNIT_TEST(externalSortForeach);
+    CPPUNIT_TEST(loadLines);
+    CPPUNIT_TEST(loadRecords);
+    CPPUNIT_TEST(packList);
+    CPPUNIT_TEST(packListIntersection);
+    CPPUNIT_TEST(wheel);
+    CPPUNIT_TEST(clist);
+    CPPUNIT_TEST(clistMergeSort);
+    CPPUNIT_TEST(fixedList);
+    CPPUNIT_TEST(fixedListWrapper);
 #ifdef _REGEX_H
     CPPUNIT_TEST(regex);
     CPPUNIT_TEST(regexDelete);
+    CPPUNIT_TEST(regexRemoveIf);
 #endif
     CPPUNIT_TEST_SUITE_END();
   public:
@@ -66,9 +124,52 @@ class ListTest : public CPPUNIT_NS::TestFixture
     void swapFirst();
     void swapFail();
     void sort();
+    void removeIf();
+    void filter();
+    void partition();
+    void stats();
+    void statsThreads();
+    void allocator();
+    void allocatorFailure();
+    void shmRelocatable();
+    void shmFull();
+    void shmTruncated();
+    void cowSnapshot();
+    void cowInsertRemove();
+    void cowLarge();
+    void dequeAgainstStd();
+    void dequeCursor();
+    void rankAgainstStd();
+    void rankIteration();
+    void rcuBasic();
+    void rcuConcurrent();
+    void pqueueOrder();
+    void pqueueHandles();
+    void moveNodes();
+    void lruCache();
+    void lruSameKey();
+    void keyListLevels();
+    void getAt();
+    void arena();
+    void splice();
+    void chan();
+    void chanThreads();
+    void setOps();
+    void externalSort();
+    void externalSortForeach();
+    void loadLines();
+    void loadRecords();
+    void packList();
+    void packListIntersection();
+    void wheel();
+    void clist();
+    void clistMergeSort();
+    void fixedList();
+    void fixedListWrapper();
 #ifdef _REGEX_H
     void regex();
     void regexDelete();
+    void regexRemoveIf();
 #endif
 
   private: